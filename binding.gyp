@@ -74,6 +74,38 @@
         'src/greenworks_async_workers.h',
         'src/greenworks_workshop_workers.cc',
         'src/greenworks_workshop_workers.h',
+        'src/greenworks_snapshot_channel.cc',
+        'src/greenworks_snapshot_channel.h',
+        'src/greenworks_state_channel.cc',
+        'src/greenworks_state_channel.h',
+        'src/greenworks_networking_transport.cc',
+        'src/greenworks_networking_transport.h',
+        'src/greenworks_cloud_cache.cc',
+        'src/greenworks_cloud_cache.h',
+        'src/greenworks_cloud_calls.cc',
+        'src/greenworks_cloud_calls.h',
+        'src/greenworks_cloud_compression.cc',
+        'src/greenworks_cloud_compression.h',
+        'src/greenworks_cloud_sync.cc',
+        'src/greenworks_cloud_sync.h',
+        'src/greenworks_clock_sync.cc',
+        'src/greenworks_clock_sync.h',
+        'src/greenworks_jitter_buffer.cc',
+        'src/greenworks_jitter_buffer.h',
+        'src/greenworks_loopback_transport.cc',
+        'src/greenworks_loopback_transport.h',
+        'src/greenworks_message_pool.cc',
+        'src/greenworks_message_pool.h',
+        'src/greenworks_packet_capture.cc',
+        'src/greenworks_packet_capture.h',
+        'src/greenworks_rate_controller.cc',
+        'src/greenworks_rate_controller.h',
+        'src/greenworks_reliable_stream.cc',
+        'src/greenworks_reliable_stream.h',
+        'src/greenworks_session_pool.cc',
+        'src/greenworks_session_pool.h',
+        'src/greenworks_voice.cc',
+        'src/greenworks_voice.h',
         'src/greenworks_utils.cc',
         'src/greenworks_utils.h',
         'src/greenworks_unzip.cc',
@@ -97,7 +129,8 @@
           '<(steamworks_sdk_dir)/redistributable_bin/<(redist_bin_dir)/<(lib_steam)'
         ]
       },
-      'defines': [ 'NAPI_DISABLE_CPP_EXCEPTIONS' ],
+      # The bundled zlib is built without its symbol prefixes; match it when calling zlib directly.
+      'defines': [ 'NAPI_DISABLE_CPP_EXCEPTIONS', 'CHROMIUM_ZLIB_NO_CHROMECONF' ],
       'conditions': [
         ['OS== "linux"',
           {
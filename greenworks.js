@@ -2,6 +2,9 @@ var fs = require("fs");
 var archiver = require("archiver");
 var unzip = require("unzip");
 var path = require("path");
+var Readable = require("stream").Readable;
+var Transform = require("stream").Transform;
+var zlib = require("zlib");
 
 var greenworks;
 
@@ -84,6 +87,114 @@ greenworks.ugcPublishUpdate = function(publishedFileID, fileName, title, descrip
     }, function(err) { error_process(err, errorCallback); });
 };
 
+// Header of files written with setCloudCompression on: "GWZ\1" and the original size as a
+// little-endian uint64, then a zlib stream. See src/greenworks_cloud_compression.h.
+var CLOUD_COMPRESSION_MAGIC = Buffer.from([0x47, 0x57, 0x5a, 0x01]);
+var CLOUD_COMPRESSION_HEADER_SIZE = 12;
+
+// Inflates a compressed cloud file as it streams past; other files pass through untouched.
+function createCloudFileDecoder() {
+    var head = Buffer.alloc(0);
+    var inflate = null;
+    var decided = false;
+    var decoder = new Transform({
+        transform: function(chunk, encoding, done) {
+            if (!decided) {
+                head = Buffer.concat([head, chunk]);
+                if (head.length < CLOUD_COMPRESSION_HEADER_SIZE) {
+                    done();
+                    return;
+                }
+                decided = true;
+                chunk = head;
+                if (head.slice(0, CLOUD_COMPRESSION_MAGIC.length).equals(CLOUD_COMPRESSION_MAGIC)) {
+                    inflate = zlib.createInflate();
+                    inflate.on("data", function(data) {
+                        decoder.push(data);
+                    });
+                    inflate.on("error", function(err) {
+                        decoder.destroy(err);
+                    });
+                    chunk = head.slice(CLOUD_COMPRESSION_HEADER_SIZE);
+                }
+            }
+            if (inflate) {
+                inflate.write(chunk, function() {
+                    done();
+                });
+            } else {
+                done(null, chunk);
+            }
+        },
+        flush: function(done) {
+            if (!decided) {
+                done(null, head);
+                return;
+            }
+            if (!inflate) {
+                done();
+                return;
+            }
+            inflate.on("end", function() {
+                done();
+            });
+            inflate.end();
+        }
+    });
+    return decoder;
+}
+
+// Streams a Steam Cloud file through readFileSlice, one chunk in memory at a time, inflating it
+// when it was stored compressed.
+greenworks.createCloudFileReadStream = function(fileName, options) {
+    var chunkSize = (options && options.chunkSize) || 1024 * 1024;
+    var offset = 0;
+    var decoder = createCloudFileDecoder();
+    var stream = new Readable({
+        highWaterMark: chunkSize,
+        read: function() {
+            greenworks.readFileSlice(fileName, offset, chunkSize, function(err, chunk, fileSize) {
+                if (err) {
+                    decoder.destroy(err);
+                    return;
+                }
+                offset += chunk.length;
+                if (chunk.length > 0) {
+                    stream.push(chunk);
+                }
+                if (chunk.length === 0 || offset >= fileSize) {
+                    stream.push(null);
+                }
+            });
+        }
+    });
+    return stream.pipe(decoder);
+};
+
+// Collects cloud writes and deletes, then commits them in one Steam write batch on a worker thread.
+greenworks.createCloudWriteBatch = function() {
+    var operations = [];
+    var batch = {
+        writeFile: function(fileName, data) {
+            if (typeof data === "string") {
+                data = Buffer.from(data);
+            }
+            operations.push({ name: fileName, data: data });
+            return batch;
+        },
+        deleteFile: function(fileName) {
+            operations.push({ name: fileName });
+            return batch;
+        },
+        commit: function(callback) {
+            var pending = operations;
+            operations = [];
+            greenworks.commitCloudWriteBatch(pending, callback);
+        }
+    };
+    return batch;
+};
+
 // Greenworks Utils APIs implmentation.
 greenworks.Utils.move = function(sourceDir, targetDir, successCallback, errorCallback) {
     fs.rename(sourceDir, targetDir, function(err) {
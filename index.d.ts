@@ -30,10 +30,31 @@ export interface ISteamworks {
     setLobbyData(lobbyId: string, name: string, value: string): boolean;
     getLobbyOwner(lobbyId: string): string | undefined;
     getLobbyMembers(lobbyId: string): ISteamFriend[] | undefined;
+    getLobbyMemberData(lobbyId: string, steamId: string, name: string): string | undefined;
+    setLobbyMemberData(lobbyId: string, name: string, value: string): void;
     ugcGetUserItems(type: number, sort: number, listType: number, cb: (err: string | null, items: IWorkshopItem[]) => void): void;
     ugcSynchronizeItems(path: string, cb: (err: string | null, items: IWorkshopItem[]) => void): void;
     ugcUnsubscribe(publishId: string, cb: (err: string | null) => void): void;
-    saveFilesToCloud(files: string[], cb: (err: string | null) => void): void;
+    saveFilesToCloud(files: string[], cb: (err: string | null) => void,
+        progress?: (path: string, bytesWritten: number, fileSize: number, fileIndex: number) => void): void;
+    // Uploads only files whose size or CRC-32 changed since the last sync; progress covers uploaded files.
+    syncFilesToCloud(files: string[], cb: (err: string | null, result: { uploaded: string[], skipped: string[] }) => void,
+        progress?: (path: string, bytesWritten: number, fileSize: number, fileIndex: number) => void): void;
+    readFile(name: string, cb: (err: Error | null, data: Buffer) => void): void;
+    readFile(name: string, encoding: BufferEncoding, cb: (err: Error | null, data: string) => void): void;
+    writeFile(name: string, data: Uint8Array, cb: (err: Error | null) => void): void;
+    // Writes entries with data and deletes entries without, in order, inside one Steam write batch.
+    commitCloudWriteBatch(operations: { name: string, data?: Uint8Array }[], cb: (err: Error | null) => void): void;
+    createCloudWriteBatch(): ICloudWriteBatch;
+    // Deflates cloud files written from now on (level 0-9, default 6); reads inflate them either way.
+    setCloudCompression(enabled: boolean, level?: number): void;
+    // Bytes of file content readFile keeps in memory; 0, the default, turns the cache off.
+    setCloudCacheBudget(bytes: number): void;
+    getCloudCacheStats(): ICloudCacheStats;
+    // Reads at most length bytes at offset as stored, compressed or not; fileSize is the stored size.
+    readFileSlice(name: string, offset: number, length: number, cb: (err: Error | null, data: Buffer, fileSize: number) => void): void;
+    // Reads the file chunk by chunk with readFileSlice; chunkSize defaults to 1MB.
+    createCloudFileReadStream(name: string, options?: { chunkSize?: number }): NodeJS.ReadableStream;
     publishWorkshopFile(path: string, imagePath: string, title: string, description: string, tags: string[], cb: (err: string | null, publishedFileId2: string) => void): void;
     updatePublishedWorkshopFile(publishFileId: string, path: string, imagePath: string, title: string, description: string, tags: string[], cb: (err: string | null, publishedFileId2: string) => void): void;
     fileShare(path: string, cb: (err: string | null) => void): void;
@@ -50,26 +71,121 @@ export interface ISteamworks {
     onLobbyJoinRequested(cb: (lobbyId: string | undefined) => void): void;
     getFileCount(): number;
     getFileNameAndSize(index: number): IRemoteFile;
+    listCloudFiles(cb: (err: Error | null, files: ICloudFileList) => void): void;
     deleteRemoteFile(name: string): void;
+    // With forget, files leave the cloud but keep their local copies. results[i] is 1 where names[i] succeeded.
+    deleteRemoteFiles(names: string[], cb: (err: Error | null, result: { succeeded: number, results: Uint8Array }) => void): void;
+    deleteRemoteFiles(names: string[], options: { forget?: boolean },
+        cb: (err: Error | null, result: { succeeded: number, results: Uint8Array }) => void): void;
 }
 
 export interface ISteamworksNetworking {
     initRelayNetworkAccess(): undefined;
     getRelayNetworkStatus(): ISteamNetworkRelayStatus;
+    waitForRelayNetwork(timeoutMs?: number): Promise<ISteamNetworkRelayStatus>;
+    setRelayNetworkStatusCallback(callback: (status: ISteamNetworkRelayStatus) => void): void;
+
+    // Ping locations are passed around as strings, e.g. published with setLobbyMemberData. The
+    // estimates are in ms and negative when unknown.
+    getLocalPingLocation(): { location: string; ageSeconds: number } | undefined;
+    isValidPingLocation(location: string): boolean;
+    estimatePingTimeBetweenTwoLocations(location1: string, location2: string): number;
+    estimatePingTimeFromLocalHost(location: string): number;
+    // Pairwise estimates between all lobby members from the locations published under key.
+    // pingMs[i * members.length + j] is the ping between members[i] and members[j].
+    getLobbyPingMatrix(lobbyId: string, key: string): { members: string[]; pingMs: Int32Array };
 
     acceptSessionWithUser(steamIdRemote: string): boolean;
     sendMessageToUser(steamIdRemote: string, data: Uint8Array): number;
+    // Pooled, uninitialized native memory to fill and pass to sendMessageToUser.
+    acquireSendBuffer(size: number): Uint8Array;
+    getSendBufferStats(): ISteamNetworkSendBufferStats;
+    // Recommended bytes to send per peer in the next tick (default 50ms), adapted to each session's
+    // ping, loss and queue. Peers are tracked from their first sendMessageToUser.
+    getSendBudgets(tickMs?: number): ISteamNetworkSendBudget[];
+    getSendBudget(steamIdRemote: string, tickMs?: number): ISteamNetworkSendBudget | undefined;
     closeSessionWithUser(steamIdRemote: string): boolean;
     getSessionConnectionInfo(steamIdRemote: string): ISteamNetworkSessionConnectionInfo;
 
     receiveMessagesOnChannel(): Array<{ steamIdRemote: string; data: Uint8Array }> | undefined;
+    // channel defaults to 0 and must be 0 or above 6, as 1-6 are reserved. maxMessages defaults to 256,
+    // capped at 5120.
+    receiveMessageBatch(channel?: number, maxMessages?: number): ISteamNetworkMessageBatch | undefined;
+
+    // Flow-controlled reliable streams per peer and channel (default 0; 1-6 are reserved, so streams
+    // use 0 or a channel above 6). writeStream returns false once the producer should wait for the
+    // drain callback. highWaterMark defaults to 1MB and sendWindow, the most reliable bytes left
+    // pending in Steam per peer, to 4MB.
+    writeStream(steamIdRemote: string, data: Uint8Array, channel?: number): boolean;
+    setStreamOptions(options: { highWaterMark: number; sendWindow: number }): void;
+    setStreamDrainCallback(callback: (steamIdRemote: string, channel: number) => void): void;
+    getStreamStatus(steamIdRemote: string, channel?: number): ISteamNetworkStreamStatus | undefined;
+
+    // Voice over channel 6, captured and decoded on a native thread. samples is reused between
+    // calls; only the first sampleCount entries are valid and only until the callback returns.
+    // startVoice returns the sample rate.
+    startVoice(callback: (steamIdRemote: string, samples: Float32Array, sampleCount: number, sampleRate: number) => void): number;
+    stopVoice(): void;
+    setVoiceRecording(recording: boolean): void;
+    setVoiceTargets(steamIds: string[]): void;
+    getVoiceStats(): ISteamVoiceStats;
+
+    sendSnapshot(steamIdRemote: string, data: Uint8Array): number;
+    receiveSnapshots(): Array<{ steamIdRemote: string; sequence: number; data: Uint8Array }> | undefined;
+    resetSnapshotPeer(steamIdRemote: string): void;
+    getSnapshotStats(): ISteamNetworkSnapshotStats;
+
+    // Latest-value-wins updates: queueing replaces any unsent update for the same key, and stale
+    // updates are dropped on receive. flushStateUpdates returns the number of packets sent.
+    queueStateUpdate(steamIdRemote: string, key: number, data: Uint8Array): void;
+    flushStateUpdates(maxBytesPerPeer?: number): number;
+    receiveStateUpdates(): Array<{ steamIdRemote: string; key: number; sequence: number; data: Uint8Array }> | undefined;
+    getStateChannelStats(): ISteamNetworkStateChannelStats;
+
+    // Time-stamped unreliable messages, released by a per-peer jitter buffer at the pace they were
+    // sent. channel defaults to 4; other channels must be 0 or above 6, as 1-6 are reserved.
+    sendTimedMessage(steamIdRemote: string, data: Uint8Array, channel?: number): number;
+    receiveTimedMessages(channel?: number): Array<{ steamIdRemote: string; senderTime: number; data: Uint8Array }> | undefined;
+    getJitterBufferStats(steamIdRemote: string, channel?: number): ISteamNetworkJitterBufferStats | undefined;
+
+    // Keeps an NTP-style estimate of the peer's clock, exchanged on channel 5. Add offsetMs to a
+    // local timestamp to get the peer's. Undefined until the first answer has arrived.
+    startClockSync(steamIdRemote: string): void;
+    stopClockSync(steamIdRemote: string): void;
+    getClockSync(steamIdRemote: string): ISteamNetworkClockSync | undefined;
+
+    // Opens sessions ahead of the first message, e.g. for every lobby member. Pooled sessions get a
+    // keepalive while idle and are closed after idleTimeoutMs without traffic (0 disables either).
+    prewarmSessions(steamIdRemotes: string[]): void;
+    setSessionPoolOptions(keepaliveMs: number, idleTimeoutMs: number): void;
+    setSessionPoolCallback(callback: (steamIdRemote: string, state: SteamNetworkingConnectionState, warmUpMs: number, idleClosed: boolean) => void): void;
+    getSessionPoolStatus(): Array<{ steamIdRemote: string; state: SteamNetworkingConnectionState; warmUpMs: number }>;
 
     setSteamNetworkingMessagesSessionRequestCallback(callback: (steamIdRemote: string) => void): void;
     setSteamNetworkingMessagesSessionFailedCallback(callback: (steamIdRemote: string, state: SteamNetworkingConnectionState, endReason: number) => void): void;
     setSteamNetworkingConnectionStatusCallback(callback: (steamIdRemote: string, state: SteamNetworkingConnectionState, endReason: number, oldState: SteamNetworkingConnectionState) => void): void;
     setSteamNetworkingSendRates(min: number, max: number): void;
+    // Global unless an HSteamNetConnection handle is passed.
+    setConfigValue(name: SteamNetworkingConfigName, value: number, connection?: number): boolean;
+    getConfigValue(name: SteamNetworkingConfigName, connection?: number): number | undefined;
     setSteamNetworkingDebugCallback(callback: (type: number, message: string) => void): void;
 
+    // In-process peers standing in for Steam; every binding above goes through the active peer.
+    enableLoopback(config?: ISteamNetworkLoopbackLinkConfig): string;
+    disableLoopback(): void;
+    createLoopbackPeer(): string;
+    setLoopbackActivePeer(steamId: string): boolean;
+    setLoopbackLinkConfig(config: ISteamNetworkLoopbackLinkConfig, steamId?: string): boolean;
+    getLoopbackStats(): ISteamNetworkLoopbackStats | undefined;
+
+    // Capture writes every message sent or received to a file; replay feeds a capture's inbound
+    // messages back in. speed: 1 = recorded timing, 0 = as fast as possible.
+    startCapture(path: string): boolean;
+    stopCapture(): { records: number; bytes: number } | undefined;
+    startReplay(path: string, speed?: number): boolean;
+    stopReplay(): void;
+    getReplayStatus(): { replayed: number; finished: boolean } | undefined;
+
     // ISteamNetworking - this is deprecated. use the above ISteamNetworkingMessages instead
     // acceptP2PSessionWithUser(steamIdRemote: string): boolean;
     // isP2PPacketAvailable(): number;
@@ -117,6 +233,33 @@ export interface IRemoteFile {
     size: number;
 }
 
+export interface ICloudCacheStats {
+    hits: number;
+    misses: number;
+    evictions: number;
+    entries: number;
+    bytes: number;
+    budget: number;
+}
+
+export interface ICloudWriteBatch {
+    writeFile(name: string, data: Uint8Array | string): ICloudWriteBatch;
+    deleteFile(name: string): ICloudWriteBatch;
+    commit(cb: (err: Error | null) => void): void;
+}
+
+// Every cloud file in one result; entry i of each column describes names[i].
+export interface ICloudFileList {
+    count: number;
+    names: string[];
+    sizes: Int32Array;
+    // Seconds since the Unix epoch.
+    timestamps: Float64Array;
+    persisted: Uint8Array;
+    // ERemoteStoragePlatform bit flags.
+    syncPlatforms: Uint32Array;
+}
+
 export interface ISteamNetworkRelayStatus {
     availabilitySummary: number;
     availabilityNetworkConfig: number;
@@ -124,6 +267,131 @@ export interface ISteamNetworkRelayStatus {
     debugMessage: string;
 }
 
+export interface ISteamNetworkSendBufferStats {
+    allocations: number;
+    reuses: number;
+    outstanding: number;
+    pooledBytes: number;
+    unpooled: number;
+}
+
+export interface ISteamNetworkSendBudget {
+    steamIdRemote: string;
+    budgetBytes: number;
+    rateBytesPerSecond: number;
+    ping: number;
+    quality: number;
+    pendingBytes: number;
+    queueTimeMs: number;
+}
+
+export interface ISteamNetworkSnapshotStats {
+    keyframesSent: number;
+    deltasSent: number;
+    snapshotBytes: number;
+    encodedBytes: number;
+    snapshotsReceived: number;
+    snapshotsDropped: number;
+}
+
+export type SteamNetworkingConfigName =
+    | 'FakePacketLag_Send'
+    | 'FakePacketLag_Recv'
+    | 'FakePacketLoss_Send'
+    | 'FakePacketLoss_Recv'
+    | 'FakePacketReorder_Send'
+    | 'FakePacketReorder_Recv'
+    | 'FakePacketReorder_Time'
+    | 'FakePacketDup_Send'
+    | 'FakePacketDup_Recv'
+    | 'FakePacketDup_TimeMax'
+    | 'FakeRateLimit_Send_Rate'
+    | 'FakeRateLimit_Send_Burst'
+    | 'FakeRateLimit_Recv_Rate'
+    | 'FakeRateLimit_Recv_Burst'
+    | 'NagleTime'
+    | 'SendBufferSize'
+    | 'SendRateMin'
+    | 'SendRateMax';
+
+export interface ISteamNetworkLoopbackLinkConfig {
+    latencyMs?: number;
+    jitterMs?: number;
+    loss?: number;
+    bandwidth?: number;
+}
+
+export interface ISteamNetworkLoopbackStats {
+    messagesSent: number;
+    messagesDelivered: number;
+    messagesDropped: number;
+    bytesSent: number;
+    bytesDelivered: number;
+    averageLatencyMs: number;
+}
+
+export interface ISteamNetworkStateChannelStats {
+    updatesQueued: number;
+    updatesReplaced: number;
+    updatesSent: number;
+    packetsSent: number;
+    bytesSent: number;
+    updatesReceived: number;
+    updatesDropped: number;
+}
+
+export interface ISteamNetworkJitterBufferStats {
+    received: number;
+    delivered: number;
+    late: number;
+    dropped: number;
+    buffered: number;
+    jitterMs: number;
+    depthMs: number;
+}
+
+// Message i is data.subarray(offsets[i], offsets[i + 1]) from peers[peerIndex[i]]. timeReceived is
+// the local timestamp in microseconds.
+export interface ISteamNetworkMessageBatch {
+    count: number;
+    data: Uint8Array;
+    offsets: Uint32Array;
+    peers: string[];
+    peerIndex: Uint32Array;
+    timeReceived: Float64Array;
+    messageNumber: Float64Array;
+    channel: Int32Array;
+    flags: Int32Array;
+}
+
+export interface ISteamNetworkStreamStatus {
+    queuedBytes: number;
+    queuedMessages: number;
+    pendingReliableBytes: number;
+    pendingUnreliableBytes: number;
+    writable: boolean;
+    sentBytes: number;
+    failedMessages: number;
+    lastResult: number;
+}
+
+export interface ISteamVoiceStats {
+    running: boolean;
+    sampleRate: number;
+    framesCaptured: number;
+    bytesCaptured: number;
+    framesReceived: number;
+    samplesDecoded: number;
+    samplesDropped: number;
+    decodeErrors: number;
+}
+
+export interface ISteamNetworkClockSync {
+    offsetMs: number;
+    rttMs: number;
+    samples: number;
+}
+
 export interface ISteamNetworkSessionState {
     connectionActive: number;
     connecting: number;
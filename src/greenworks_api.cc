@@ -2,6 +2,10 @@
 // Use of this source code is governed by the MIT license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
+#include <climits>
+#include <map>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -12,7 +16,22 @@
 #include "v8.h"
 
 #include "greenworks_async_workers.h"
+#include "greenworks_clock_sync.h"
+#include "greenworks_cloud_cache.h"
+#include "greenworks_cloud_calls.h"
+#include "greenworks_cloud_compression.h"
+#include "greenworks_jitter_buffer.h"
+#include "greenworks_loopback_transport.h"
+#include "greenworks_message_pool.h"
+#include "greenworks_networking_transport.h"
+#include "greenworks_packet_capture.h"
+#include "greenworks_rate_controller.h"
+#include "greenworks_reliable_stream.h"
+#include "greenworks_session_pool.h"
+#include "greenworks_snapshot_channel.h"
+#include "greenworks_state_channel.h"
 #include "greenworks_utils.h"
+#include "greenworks_voice.h"
 #include "greenworks_workshop_workers.h"
 #include "steam_callbacks.h"
 
@@ -23,9 +42,40 @@
 #define SET_FUNCTION_TPL(function_name, function) tpl.Set(function_name, Napi::Function::New(env, function))
 
 #define MESSAGE_CHANNEL 0
+#define SNAPSHOT_CHANNEL 1
+#define SESSION_POOL_CHANNEL 2
+#define STATE_CHANNEL 3
+#define TIMED_MESSAGE_CHANNEL 4
+#define CLOCK_SYNC_CHANNEL 5
+#define VOICE_CHANNEL 6
 #define MAX_MESSAGES 20
+#define DEFAULT_MESSAGE_BATCH_SIZE 256
+#define MAX_MESSAGE_BATCH_SIZE (MAX_MESSAGES * 256)
+#define MAX_POOLED_SEND_BUFFER_BYTES (64 * 1024 * 1024)
+#define DEFAULT_SEND_BUDGET_TICK_MS 50
 
 SteamCallbacks *steamCallbacks = nullptr;
+SnapshotChannel snapshotChannel;
+StateChannel stateChannel;
+std::map<std::pair<uint64, int>, JitterBuffer> jitterBuffers;
+ClockSync clockSync(CLOCK_SYNC_CHANNEL);
+MessageBufferPool sendBufferPool(MAX_POOLED_SEND_BUFFER_BYTES);
+SessionPool sessionPool(SESSION_POOL_CHANNEL);
+Napi::FunctionReference sessionPoolCallback;
+SendRateController sendRateController;
+ReliableStreams reliableStreams;
+Napi::FunctionReference streamDrainCallback;
+VoiceChat voiceChat;
+std::vector<uint64> voiceTargets;
+Napi::FunctionReference voiceCallback;
+Napi::ThreadSafeFunction voiceWakeFunction;
+Napi::Reference<Napi::Float32Array> voiceSamples;
+uint64 unpooledSendBuffers = 0;
+std::unique_ptr<LoopbackNetwork> loopbackNetwork;
+std::unique_ptr<CaptureWriter> captureWriter;
+std::unique_ptr<CaptureTransport> captureTransport;
+std::unique_ptr<CaptureReader> replayReader;
+std::unique_ptr<ReplayTransport> replayTransport;
 Napi::ThreadSafeFunction steamNetworkingDebugCallback;
 
 Napi::Object GetSteamUserCountType(Napi::Env env, int type_id)
@@ -152,40 +202,357 @@ Napi::Value GetSteamId(const Napi::CallbackInfo &info)
     return result;
 }
 
+// Forgets everything kept for |peer| once its session is closed, whether by closeSessionWithUser
+// or by the session pool's idle timeout.
+void ResetPeer(uint64 peer)
+{
+    snapshotChannel.ResetPeer(peer);
+    stateChannel.ResetPeer(peer);
+    auto jitterBuffer = jitterBuffers.lower_bound(std::make_pair(peer, INT_MIN));
+    while (jitterBuffer != jitterBuffers.end() && jitterBuffer->first.first == peer)
+    {
+        jitterBuffer = jitterBuffers.erase(jitterBuffer);
+    }
+    sessionPool.Remove(peer);
+    sendRateController.Untrack(peer);
+    clockSync.Stop(peer);
+    reliableStreams.Remove(peer);
+}
+
+// Traffic on any channel but the pool's own keepalives keeps a pooled session from going idle.
+void OnNetworkingActivity(uint64 peer, int channel)
+{
+    if (channel != SESSION_POOL_CHANNEL)
+        sessionPool.Touch(peer);
+}
+
+// Sends what the voice thread captured to the voice targets and hands decoded audio to the voice
+// callback, one call per peer, in a Float32Array that is reused between calls.
+void FlushVoice(Napi::Env env)
+{
+    std::vector<std::vector<uint8>> captured;
+    std::map<uint64, std::vector<float>> decoded;
+    voiceChat.Take(&captured, &decoded);
+
+    NetworkingTransport *transport = GetNetworkingTransport();
+    for (const std::vector<uint8> &frame : captured)
+    {
+        for (uint64 target : voiceTargets)
+        {
+            SteamNetworkingIdentity identity;
+            identity.SetSteamID64(target);
+            transport->SendMessageToUser(identity, frame.data(), static_cast<uint32>(frame.size()),
+                                         k_nSteamNetworkingSend_UnreliableNoNagle |
+                                             k_nSteamNetworkingSend_AutoRestartBrokenSession,
+                                         VOICE_CHANNEL);
+        }
+    }
+
+    if (voiceCallback.IsEmpty() || voiceSamples.IsEmpty())
+    {
+        return;
+    }
+
+    Napi::Float32Array samples = voiceSamples.Value();
+    for (const auto &pcm : decoded)
+    {
+        size_t count = std::min(pcm.second.size(), samples.ElementLength());
+        memcpy(samples.Data(), pcm.second.data(), count * sizeof(float));
+        voiceCallback.Call({Napi::String::New(env, utils::uint64ToString(pcm.first)), samples,
+                            Napi::Number::New(env, static_cast<double>(count)),
+                            Napi::Number::New(env, voiceChat.GetSampleRate())});
+    }
+}
+
 Napi::Value RunCallbacks(const Napi::CallbackInfo &info)
 {
     Napi::Env env = info.Env();
 
     SteamAPI_RunCallbacks();
 
+    if (steamCallbacks != nullptr)
+    {
+        steamCallbacks->ExpireRelayNetworkWaiters();
+    }
+
+    std::vector<uint64> ratePeers = sendRateController.GetTrackedPeers();
+    if (!ratePeers.empty())
+    {
+        NetworkingTransport *transport = GetNetworkingTransport();
+        SteamNetworkingMicroseconds now = transport->GetLocalTimestamp();
+        for (uint64 peer : ratePeers)
+        {
+            SteamNetworkingIdentity identity;
+            identity.SetSteamID64(peer);
+            SteamNetConnectionRealTimeStatus_t status;
+            memset(&status, 0, sizeof(status));
+            // Steam leaves |status| untouched when it has no session for the peer.
+            if (transport->GetSessionConnectionInfo(identity, nullptr, &status) ==
+                k_ESteamNetworkingConnectionState_None)
+                continue;
+            sendRateController.Update(peer, status, now);
+        }
+    }
+
+    clockSync.Tick();
+
+    if (voiceChat.IsRunning())
+    {
+        SteamNetworkingMessage_t *messages[MAX_MESSAGES];
+        int messageCount;
+        while ((messageCount = GetNetworkingTransport()->ReceiveMessagesOnChannel(VOICE_CHANNEL, messages,
+                                                                                  MAX_MESSAGES)) > 0)
+        {
+            for (int i = 0; i < messageCount; i++)
+            {
+                voiceChat.PushInbound(messages[i]->m_identityPeer.GetSteamID64(), messages[i]->GetData(),
+                                      messages[i]->m_cbSize);
+                messages[i]->Release();
+            }
+        }
+        FlushVoice(env);
+    }
+
+    std::vector<ReliableStreams::StreamId> drainedStreams;
+    reliableStreams.Tick(&drainedStreams);
+    if (!streamDrainCallback.IsEmpty())
+    {
+        for (const ReliableStreams::StreamId &stream : drainedStreams)
+        {
+            streamDrainCallback.Call({Napi::String::New(env, utils::uint64ToString(stream.first)),
+                                      Napi::Number::New(env, stream.second)});
+        }
+    }
+
+    std::vector<SessionPool::Event> sessionEvents;
+    sessionPool.Tick(&sessionEvents);
+    for (const SessionPool::Event &event : sessionEvents)
+    {
+        if (event.type == SessionPool::kSessionIdleClosed)
+            ResetPeer(event.peer);
+    }
+    if (!sessionPoolCallback.IsEmpty())
+    {
+        for (const SessionPool::Event &event : sessionEvents)
+        {
+            sessionPoolCallback.Call({Napi::String::New(env, utils::uint64ToString(event.peer)),
+                                      Napi::Number::New(env, event.state),
+                                      Napi::Number::New(env, static_cast<double>(event.warm_up_ms)),
+                                      Napi::Boolean::New(env, event.type == SessionPool::kSessionIdleClosed)});
+        }
+    }
+
     return env.Undefined();
 }
 
+bool GetFilesPath(Napi::Array files, std::vector<std::string> *files_path)
+{
+    for (uint32_t i = 0; i < files.Length(); ++i)
+    {
+        if (!(files).Get(i).IsString())
+            return false;
+        std::string string_array = (files).Get(i).ToString().Utf8Value();
+        // Ignore empty path.
+        if (string_array.length() > 0)
+            files_path->push_back(string_array);
+    }
+    return true;
+}
+
 Napi::Value SaveFilesToCloud(const Napi::CallbackInfo &info)
 {
     Napi::Env env = info.Env();
     if (info.Length() < 2 || !info[0].IsArray() || !info[1].IsFunction())
     {
         THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
     }
-    Napi::Array files = info[0].As<Napi::Array>();
     std::vector<std::string> files_path;
-    for (uint32_t i = 0; i < files.Length(); ++i)
+    if (!GetFilesPath(info[0].As<Napi::Array>(), &files_path))
     {
-        if (!(files).Get(i).IsString())
-            THROW_BAD_ARGS("Bad arguments");
-        std::string string_array = (files).Get(i).ToString().Utf8Value();
-        // Ignore empty path.
-        if (string_array.length() > 0)
-            files_path.push_back(string_array);
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
     }
 
     Napi::Function callback = info[1].As<Napi::Function>();
 
+    if (info.Length() > 2 && info[2].IsFunction())
+    {
+        Napi::Function progress = info[2].As<Napi::Function>();
+        (new FilesSaveWorker(callback, files_path, progress))->Queue();
+        return env.Undefined();
+    }
+
     (new FilesSaveWorker(callback, files_path))->Queue();
     return env.Undefined();
 }
 
+Napi::Value SyncFilesToCloud(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+    if (info.Length() < 2 || !info[0].IsArray() || !info[1].IsFunction())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+    std::vector<std::string> files_path;
+    if (!GetFilesPath(info[0].As<Napi::Array>(), &files_path))
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    Napi::Function callback = info[1].As<Napi::Function>();
+
+    if (info.Length() > 2 && info[2].IsFunction())
+    {
+        Napi::Function progress = info[2].As<Napi::Function>();
+        (new FilesSyncWorker(callback, files_path, progress))->Queue();
+        return env.Undefined();
+    }
+
+    (new FilesSyncWorker(callback, files_path))->Queue();
+    return env.Undefined();
+}
+
+Napi::Value ReadFile(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    // readFile(name, [encoding], callback)
+    size_t callbackIndex = info.Length() > 2 ? 2 : 1;
+    if (info.Length() < 2 || !info[0].IsString() || !info[callbackIndex].IsFunction() ||
+        (callbackIndex == 2 && !info[1].IsUndefined() && !info[1].IsString()))
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    std::string file_name = info[0].ToString().Utf8Value();
+    std::string encoding = callbackIndex == 2 && info[1].IsString() ? info[1].ToString().Utf8Value() : "";
+    Napi::Function callback = info[callbackIndex].As<Napi::Function>();
+
+    (new FileReadWorker(callback, file_name, encoding))->Queue();
+    return env.Undefined();
+}
+
+Napi::Value ReadFileSlice(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 4 || !info[0].IsString() || !info[1].IsNumber() || !info[2].IsNumber() ||
+        !info[3].IsFunction() || info[1].ToNumber().Int64Value() < 0 || info[2].ToNumber().Int64Value() < 0)
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    std::string file_name = info[0].ToString().Utf8Value();
+    uint32 offset = info[1].ToNumber().Uint32Value();
+    uint32 length = info[2].ToNumber().Uint32Value();
+    Napi::Function callback = info[3].As<Napi::Function>();
+
+    (new FileReadSliceWorker(callback, file_name, offset, length))->Queue();
+    return env.Undefined();
+}
+
+// Writes the bytes of |data| with FileWriteAsync. The array is kept alive, not copied, until Steam
+// reports the write done during runCallbacks. With cloud compression on, the bytes are copied to a
+// worker that deflates them off the JS thread instead.
+Napi::Value WriteFile(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 3 || !info[0].IsString() || !info[1].IsTypedArray() || !info[2].IsFunction())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    Napi::Uint8Array array = info[1].As<Napi::TypedArray>().As<Napi::Uint8Array>();
+    if (array.ByteLength() > k_unMaxCloudFileChunkSize)
+    {
+        THROW_BAD_ARGS("File too large");
+        return env.Undefined();
+    }
+
+    std::string file_name = info[0].ToString().Utf8Value();
+    Napi::Function callback = info[2].As<Napi::Function>();
+
+    if (cloud_compression::GetSettings().enabled)
+    {
+        std::string content(reinterpret_cast<const char *>(array.Data()), array.ByteLength());
+        (new FileContentSaveWorker(callback, file_name, content))->Queue();
+        return env.Undefined();
+    }
+
+    FileWriteAsyncCall::Start(env, file_name, array, array.Data(), static_cast<uint32>(array.ByteLength()), callback);
+    return env.Undefined();
+}
+
+// setCloudCompression(enabled, [level]): deflate files written from now on with zlib |level| (0-9,
+// default 6). Reads inflate compressed files whatever the setting.
+Napi::Value SetCloudCompression(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsBoolean() || (info.Length() > 1 && !info[1].IsUndefined() &&
+                                                      !info[1].IsNumber()))
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    cloud_compression::Settings settings;
+    settings.enabled = info[0].As<Napi::Boolean>().Value();
+    settings.level = Z_DEFAULT_COMPRESSION;
+    if (info.Length() > 1 && info[1].IsNumber())
+    {
+        int level = info[1].As<Napi::Number>().Int32Value();
+        if (level < Z_NO_COMPRESSION || level > Z_BEST_COMPRESSION)
+        {
+            THROW_BAD_ARGS("Bad arguments");
+            return env.Undefined();
+        }
+        settings.level = level;
+    }
+
+    cloud_compression::SetSettings(settings);
+    return env.Undefined();
+}
+
+// setCloudCacheBudget(bytes): how much file content readFile keeps in memory; 0 turns it off.
+Napi::Value SetCloudCacheBudget(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsNumber() || info[0].As<Napi::Number>().DoubleValue() < 0)
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    GetCloudFileCache()->SetBudget(static_cast<size_t>(info[0].As<Napi::Number>().Int64Value()));
+    return env.Undefined();
+}
+
+Napi::Value GetCloudCacheStats(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    CloudFileCache::Stats stats = GetCloudFileCache()->GetStats();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("hits", Napi::Number::New(env, static_cast<double>(stats.hits)));
+    result.Set("misses", Napi::Number::New(env, static_cast<double>(stats.misses)));
+    result.Set("evictions", Napi::Number::New(env, static_cast<double>(stats.evictions)));
+    result.Set("entries", Napi::Number::New(env, static_cast<double>(stats.entries)));
+    result.Set("bytes", Napi::Number::New(env, static_cast<double>(stats.bytes)));
+    result.Set("budget", Napi::Number::New(env, static_cast<double>(stats.budget)));
+
+    return result;
+}
+
 Napi::Value GetFileCount(const Napi::CallbackInfo &info)
 {
     Napi::Env env = info.Env();
@@ -215,6 +582,21 @@ Napi::Value GetFileNameAndSize(const Napi::CallbackInfo &info)
     return fileObject;
 }
 
+Napi::Value ListCloudFiles(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsFunction())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+    Napi::Function callback = info[0].As<Napi::Function>();
+
+    (new CloudFilesListWorker(callback))->Queue();
+    return env.Undefined();
+}
+
 Napi::Value DeleteRemoteFile(const Napi::CallbackInfo &info)
 {
     Napi::Env env = info.Env();
@@ -227,10 +609,95 @@ Napi::Value DeleteRemoteFile(const Napi::CallbackInfo &info)
     std::string file_name = info[0].ToString().Utf8Value();
 
     bool result = SteamRemoteStorage()->FileDelete(file_name.c_str());
+    GetCloudFileCache()->Invalidate(file_name);
 
     return Napi::Boolean::New(env, result);
 }
 
+// commitCloudWriteBatch([{name, data?}], callback): writes every entry with data and deletes every
+// entry without, in order, inside one Steam write batch on a worker thread.
+Napi::Value CommitCloudWriteBatch(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsArray() || !info[1].IsFunction())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    Napi::Array entries = info[0].As<Napi::Array>();
+    std::vector<CloudWriteBatchWorker::Operation> operations(entries.Length());
+    for (uint32_t i = 0; i < entries.Length(); ++i)
+    {
+        Napi::Value entry = entries.Get(i);
+        if (!entry.IsObject() || !entry.As<Napi::Object>().Get("name").IsString())
+        {
+            THROW_BAD_ARGS("Bad arguments");
+            return env.Undefined();
+        }
+
+        Napi::Object object = entry.As<Napi::Object>();
+        Napi::Value data = object.Get("data");
+        CloudWriteBatchWorker::Operation &operation = operations[i];
+        operation.file_name = object.Get("name").ToString().Utf8Value();
+        operation.remove = data.IsUndefined() || data.IsNull();
+        if (operation.remove)
+            continue;
+
+        if (!data.IsTypedArray())
+        {
+            THROW_BAD_ARGS("Bad arguments");
+            return env.Undefined();
+        }
+        Napi::Uint8Array array = data.As<Napi::TypedArray>().As<Napi::Uint8Array>();
+        if (array.ByteLength() > k_unMaxCloudFileChunkSize)
+        {
+            THROW_BAD_ARGS("File too large");
+            return env.Undefined();
+        }
+        operation.content.assign(reinterpret_cast<const char *>(array.Data()), array.ByteLength());
+    }
+
+    Napi::Function callback = info[1].As<Napi::Function>();
+    (new CloudWriteBatchWorker(callback, operations))->Queue();
+    return env.Undefined();
+}
+
+// deleteRemoteFiles(names, [{forget}], callback): deletes, or forgets, every file on a worker thread.
+Napi::Value DeleteRemoteFiles(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    size_t callbackIndex = info.Length() > 2 ? 2 : 1;
+    if (info.Length() < 2 || !info[0].IsArray() || !info[callbackIndex].IsFunction() ||
+        (callbackIndex == 2 && !info[1].IsUndefined() && !info[1].IsObject()))
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    Napi::Array names = info[0].As<Napi::Array>();
+    std::vector<std::string> file_names;
+    for (uint32_t i = 0; i < names.Length(); ++i)
+    {
+        if (!names.Get(i).IsString())
+        {
+            THROW_BAD_ARGS("Bad arguments");
+            return env.Undefined();
+        }
+        file_names.push_back(names.Get(i).ToString().Utf8Value());
+    }
+
+    bool forget = false;
+    if (callbackIndex == 2 && info[1].IsObject())
+        forget = info[1].As<Napi::Object>().Get("forget").ToBoolean();
+
+    Napi::Function callback = info[callbackIndex].As<Napi::Function>();
+    (new CloudFilesDeleteWorker(callback, file_names, forget))->Queue();
+    return env.Undefined();
+}
+
 Napi::Value IsCloudEnabled(const Napi::CallbackInfo &info)
 {
     Napi::Env env = info.Env();
@@ -1027,23 +1494,68 @@ Napi::Value GetLobbyMembers(const Napi::CallbackInfo &info)
     return lobbyMembers;
 }
 
-Napi::Value OnLobbyCreated(const Napi::CallbackInfo &info)
+Napi::Value GetLobbyMemberData(const Napi::CallbackInfo &info)
 {
     Napi::Env env = info.Env();
-
-    if (info.Length() < 1 || !info[0].IsFunction())
+    if (info.Length() < 3 || !info[0].IsString() || !info[1].IsString() || !info[2].IsString())
     {
-        THROW_BAD_ARGS("Bad arguments");
+        THROW_BAD_ARGS("bad arguments");
+        return env.Undefined();
     }
 
-    if (steamCallbacks == nullptr)
-    {
-        THROW_BAD_ARGS("Internal error");
-    }
+    std::string lobbyIdString = info[0].ToString().Utf8Value();
+    std::string memberIdString = info[1].ToString().Utf8Value();
+    std::string key = info[2].ToString().Utf8Value();
 
-    if (!steamCallbacks->OnLobbyCreatedCallback.IsEmpty())
+    CSteamID lobbyId(utils::strToUint64(lobbyIdString));
+    CSteamID memberId(utils::strToUint64(memberIdString));
+
+    const char *data = SteamMatchmaking()->GetLobbyMemberData(lobbyId, memberId, key.c_str());
+    if (data == NULL)
     {
-        steamCallbacks->OnLobbyCreatedCallback.Reset();
+        return env.Undefined();
+    }
+
+    return Napi::String::New(env, data);
+}
+
+Napi::Value SetLobbyMemberData(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+    if (info.Length() < 3 || !info[0].IsString() || !info[1].IsString() || !info[2].IsString())
+    {
+        THROW_BAD_ARGS("bad arguments");
+        return env.Undefined();
+    }
+
+    std::string lobbyIdString = info[0].ToString().Utf8Value();
+    std::string key = info[1].ToString().Utf8Value();
+    std::string value = info[2].ToString().Utf8Value();
+
+    CSteamID lobbyId(utils::strToUint64(lobbyIdString));
+
+    SteamMatchmaking()->SetLobbyMemberData(lobbyId, key.c_str(), value.c_str());
+
+    return env.Undefined();
+}
+
+Napi::Value OnLobbyCreated(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsFunction())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+    }
+
+    if (steamCallbacks == nullptr)
+    {
+        THROW_BAD_ARGS("Internal error");
+    }
+
+    if (!steamCallbacks->OnLobbyCreatedCallback.IsEmpty())
+    {
+        steamCallbacks->OnLobbyCreatedCallback.Reset();
     }
 
     steamCallbacks->OnLobbyCreatedCallback = Napi::Persistent(info[0].As<Napi::Function>());
@@ -1253,6 +1765,14 @@ Napi::Value InitRelayNetworkAccess(const Napi::CallbackInfo &info)
 
     SteamNetworkingUtils()->InitRelayNetworkAccess();
 
+    if (steamCallbacks != nullptr)
+    {
+        // Seed the cached snapshot; later changes arrive through SteamRelayNetworkStatus_t.
+        SteamRelayNetworkStatus_t status;
+        SteamNetworkingUtils()->GetRelayNetworkStatus(&status);
+        steamCallbacks->UpdateRelayNetworkStatus(status);
+    }
+
     return env.Undefined();
 }
 
@@ -1260,15 +1780,237 @@ Napi::Value GetRelayNetworkStatus(const Napi::CallbackInfo &info)
 {
     Napi::Env env = info.Env();
 
+    if (steamCallbacks != nullptr && steamCallbacks->hasRelayNetworkStatus)
+    {
+        return utils::GetRelayNetworkStatusObject(env, steamCallbacks->relayNetworkStatus);
+    }
+
     SteamRelayNetworkStatus_t status;
     SteamNetworkingUtils()->GetRelayNetworkStatus(&status);
 
+    return utils::GetRelayNetworkStatusObject(env, status);
+}
+
+Napi::Value WaitForRelayNetwork(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() > 0 && !info[0].IsNumber() && !info[0].IsUndefined())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    if (steamCallbacks == nullptr)
+    {
+        THROW_BAD_ARGS("Internal error");
+        return env.Undefined();
+    }
+
+    // A timeout of 0 (or none) waits until the relay network becomes available or fails.
+    int64 timeoutMs = info.Length() > 0 && info[0].IsNumber() ? info[0].As<Napi::Number>().Int64Value() : 0;
+
+    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+
+    if (!steamCallbacks->hasRelayNetworkStatus)
+    {
+        SteamRelayNetworkStatus_t status;
+        SteamNetworkingUtils()->GetRelayNetworkStatus(&status);
+        steamCallbacks->UpdateRelayNetworkStatus(status);
+    }
+
+    const SteamRelayNetworkStatus_t &status = steamCallbacks->relayNetworkStatus;
+    if (status.m_eAvail == k_ESteamNetworkingAvailability_Current)
+    {
+        deferred.Resolve(utils::GetRelayNetworkStatusObject(env, status));
+    }
+    else if (status.m_eAvail == k_ESteamNetworkingAvailability_CannotTry ||
+             status.m_eAvail == k_ESteamNetworkingAvailability_Failed)
+    {
+        deferred.Reject(
+            Napi::Error::New(env, std::string("Relay network unavailable: ") + status.m_debugMsg).Value());
+    }
+    else
+    {
+        RelayNetworkWaiter waiter = {deferred, timeoutMs > 0,
+                                     std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs)};
+        steamCallbacks->relayNetworkWaiters.push_back(waiter);
+    }
+
+    return deferred.Promise();
+}
+
+Napi::Value SetRelayNetworkStatusCallback(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsFunction())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    if (steamCallbacks == nullptr)
+    {
+        THROW_BAD_ARGS("Internal error");
+        return env.Undefined();
+    }
+
+    if (!steamCallbacks->OnRelayNetworkStatusCallback.IsEmpty())
+    {
+        steamCallbacks->OnRelayNetworkStatusCallback.Reset();
+    }
+
+    steamCallbacks->OnRelayNetworkStatusCallback = Napi::Persistent(info[0].As<Napi::Function>());
+
+    return env.Undefined();
+}
+
+// Returns the local ping location in its string form, or undefined until relay network access has
+// measured it. ageSeconds says how old the measurement is.
+Napi::Value GetLocalPingLocation(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    SteamNetworkPingLocation_t location;
+    float age = SteamNetworkingUtils()->GetLocalPingLocation(location);
+    if (age < 0)
+    {
+        return env.Undefined();
+    }
+
+    char locationString[k_cchMaxSteamNetworkingPingLocationString];
+    SteamNetworkingUtils()->ConvertPingLocationToString(location, locationString, sizeof(locationString));
+
     Napi::Object result = Napi::Object::New(env);
+    result.Set("location", Napi::String::New(env, locationString));
+    result.Set("ageSeconds", Napi::Number::New(env, age));
+
+    return result;
+}
+
+Napi::Value IsValidPingLocation(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    SteamNetworkPingLocation_t location;
+    return Napi::Boolean::New(
+        env, SteamNetworkingUtils()->ParsePingLocationString(info[0].ToString().Utf8Value().c_str(), location));
+}
+
+Napi::Value EstimatePingTimeBetweenTwoLocations(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    SteamNetworkPingLocation_t location1;
+    SteamNetworkPingLocation_t location2;
+    if (!SteamNetworkingUtils()->ParsePingLocationString(info[0].ToString().Utf8Value().c_str(), location1) ||
+        !SteamNetworkingUtils()->ParsePingLocationString(info[1].ToString().Utf8Value().c_str(), location2))
+    {
+        return Napi::Number::New(env, k_nSteamNetworkingPing_Failed);
+    }
+
+    return Napi::Number::New(env, SteamNetworkingUtils()->EstimatePingTimeBetweenTwoLocations(location1, location2));
+}
+
+Napi::Value EstimatePingTimeFromLocalHost(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    SteamNetworkPingLocation_t location;
+    if (!SteamNetworkingUtils()->ParsePingLocationString(info[0].ToString().Utf8Value().c_str(), location))
+    {
+        return Napi::Number::New(env, k_nSteamNetworkingPing_Failed);
+    }
+
+    return Napi::Number::New(env, SteamNetworkingUtils()->EstimatePingTimeFromLocalHost(location));
+}
+
+// Estimates the ping between every pair of lobby members from the ping locations they published as
+// member data under |key|, without sending anything. pingMs is row-major, one row per entry of
+// members; pairs involving us are measured from the local host. Negative entries are unknown.
+Napi::Value GetLobbyPingMatrix(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    CSteamID lobbyId(utils::strToUint64(info[0].ToString().Utf8Value()));
+    std::string key = info[1].ToString().Utf8Value();
+    CSteamID localId = SteamUser()->GetSteamID();
 
-    result.Set("availabilitySummary", Napi::Number::New(env, status.m_eAvail));
-    result.Set("availabilityNetworkConfig", Napi::Number::New(env, status.m_eAvailNetworkConfig));
-    result.Set("availabilityAnyRelay", Napi::Number::New(env, status.m_eAvailAnyRelay));
-    result.Set("debugMessage", Napi::String::New(env, status.m_debugMsg));
+    int memberCount = SteamMatchmaking()->GetNumLobbyMembers(lobbyId);
+    if (memberCount < 0)
+    {
+        memberCount = 0;
+    }
+
+    std::vector<CSteamID> members;
+    std::vector<SteamNetworkPingLocation_t> locations(memberCount);
+    std::vector<bool> hasLocation;
+    members.reserve(memberCount);
+    hasLocation.reserve(memberCount);
+    for (int i = 0; i < memberCount; i++)
+    {
+        CSteamID member = SteamMatchmaking()->GetLobbyMemberByIndex(lobbyId, i);
+        const char *location = SteamMatchmaking()->GetLobbyMemberData(lobbyId, member, key.c_str());
+        hasLocation.push_back(location != NULL && location[0] != '\0' &&
+                              SteamNetworkingUtils()->ParsePingLocationString(location, locations[i]));
+        members.push_back(member);
+    }
+
+    Napi::Array memberIds = Napi::Array::New(env, members.size());
+    Napi::Int32Array pings = Napi::Int32Array::New(env, members.size() * members.size());
+    for (size_t i = 0; i < members.size(); i++)
+    {
+        memberIds.Set(i, Napi::String::New(env, utils::uint64ToString(members[i].ConvertToUint64())));
+        pings[i * members.size() + i] = 0;
+
+        for (size_t j = i + 1; j < members.size(); j++)
+        {
+            int ping = k_nSteamNetworkingPing_Failed;
+            if (members[i] == localId && hasLocation[j])
+            {
+                ping = SteamNetworkingUtils()->EstimatePingTimeFromLocalHost(locations[j]);
+            }
+            else if (members[j] == localId && hasLocation[i])
+            {
+                ping = SteamNetworkingUtils()->EstimatePingTimeFromLocalHost(locations[i]);
+            }
+            else if (hasLocation[i] && hasLocation[j])
+            {
+                ping = SteamNetworkingUtils()->EstimatePingTimeBetweenTwoLocations(locations[i], locations[j]);
+            }
+            pings[i * members.size() + j] = ping;
+            pings[j * members.size() + i] = ping;
+        }
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("members", memberIds);
+    result.Set("pingMs", pings);
 
     return result;
 }
@@ -1287,7 +2029,7 @@ Napi::Value AcceptSessionWithUser(const Napi::CallbackInfo &info)
     SteamNetworkingIdentity steamNetworkingIdentity;
     steamNetworkingIdentity.SetSteamID64(utils::strToUint64(steamIdString));
 
-    bool result = SteamNetworkingMessages()->AcceptSessionWithUser(steamNetworkingIdentity);
+    bool result = GetNetworkingTransport()->AcceptSessionWithUser(steamNetworkingIdentity);
 
     return Napi::Boolean::New(env, result);
 }
@@ -1310,87 +2052,437 @@ Napi::Value SendMessageToUser(const Napi::CallbackInfo &info)
     SteamNetworkingIdentity steamNetworkingIdentity;
     steamNetworkingIdentity.SetSteamID64(utils::strToUint64(steamIdString));
 
-    EResult result = SteamNetworkingMessages()->SendMessageToUser(
+    EResult result = GetNetworkingTransport()->SendMessageToUser(
         steamNetworkingIdentity, dst, length,
         k_nSteamNetworkingSend_Reliable | k_nSteamNetworkingSend_AutoRestartBrokenSession, MESSAGE_CHANNEL);
 
+    sendRateController.Track(steamNetworkingIdentity.GetSteamID64());
+
     return Napi::Number::New(env, result);
 }
 
-Napi::Value CloseSessionWithUser(const Napi::CallbackInfo &info)
+// Channels 1-6 carry greenworks' own traffic (snapshots, session pool, state, timed messages, clock
+// sync, voice); channels chosen by the caller must be 0 or above 6.
+bool IsUserChannel(int channel)
+{
+    return channel == MESSAGE_CHANNEL || channel > VOICE_CHANNEL;
+}
+
+// Queues |data| on the flow-controlled reliable stream to the peer. Returns false once the producer
+// should stop writing until the drain callback fires for the stream.
+Napi::Value WriteStream(const Napi::CallbackInfo &info)
 {
     Napi::Env env = info.Env();
 
-    if (info.Length() < 1 || !info[0].IsString())
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsTypedArray() ||
+        (info.Length() > 2 && !info[2].IsUndefined() && !info[2].IsNumber()))
     {
         THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
     }
 
-    std::string steamIdString = info[0].ToString().Utf8Value();
+    Napi::Uint8Array array = info[1].As<Napi::TypedArray>().As<Napi::Uint8Array>();
+    if (array.ByteLength() > static_cast<size_t>(k_cbMaxSteamNetworkingSocketsMessageSizeSend))
+    {
+        THROW_BAD_ARGS("Message too large");
+        return env.Undefined();
+    }
 
-    SteamNetworkingIdentity steamNetworkingIdentity;
-    steamNetworkingIdentity.SetSteamID64(utils::strToUint64(steamIdString));
+    uint64 peer = utils::strToUint64(info[0].ToString().Utf8Value());
+    int channel = info.Length() > 2 && info[2].IsNumber() ? info[2].ToNumber().Int32Value() : MESSAGE_CHANNEL;
+    if (!IsUserChannel(channel))
+    {
+        THROW_BAD_ARGS("Reserved channel");
+        return env.Undefined();
+    }
 
-    bool result = SteamNetworkingMessages()->CloseSessionWithUser(steamNetworkingIdentity);
+    bool writable = reliableStreams.Write(peer, channel, array.Data(), static_cast<uint32>(array.ByteLength()));
 
-    return Napi::Boolean::New(env, result);
+    sendRateController.Track(peer);
+
+    return Napi::Boolean::New(env, writable);
 }
 
-Napi::Value GetSessionConnectionInfo(const Napi::CallbackInfo &info)
+Napi::Value SetStreamOptions(const Napi::CallbackInfo &info)
 {
     Napi::Env env = info.Env();
 
-    if (info.Length() < 1 || !info[0].IsString())
+    if (info.Length() < 1 || !info[0].IsObject())
     {
         THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
     }
 
-    std::string steamIdString = info[0].ToString().Utf8Value();
+    Napi::Object options = info[0].As<Napi::Object>();
+    Napi::Value highWaterMark = options.Get("highWaterMark");
+    Napi::Value sendWindow = options.Get("sendWindow");
+    if (!highWaterMark.IsNumber() || !sendWindow.IsNumber() || highWaterMark.ToNumber().Int64Value() <= 0 ||
+        sendWindow.ToNumber().Int64Value() <= 0)
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
 
-    SteamNetworkingIdentity steamNetworkingIdentity;
-    steamNetworkingIdentity.SetSteamID64(utils::strToUint64(steamIdString));
+    reliableStreams.SetOptions(highWaterMark.ToNumber().Uint32Value(), sendWindow.ToNumber().Uint32Value());
 
-    SteamNetConnectionInfo_t connectionInfo;
-    SteamNetworkingMessages()->GetSessionConnectionInfo(steamNetworkingIdentity, &connectionInfo, nullptr);
+    return env.Undefined();
+}
 
-    Napi::Object result = Napi::Object::New(env);
+Napi::Value SetStreamDrainCallback(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
 
-    result.Set("state", Napi::Number::New(env, connectionInfo.m_eState));
-    result.Set("endReason", Napi::Number::New(env, connectionInfo.m_eEndReason));
-    result.Set("connectionDescription", Napi::String::New(env, connectionInfo.m_szConnectionDescription));
-    result.Set("endDebug", Napi::String::New(env, connectionInfo.m_szEndDebug));
+    if (info.Length() < 1 || !info[0].IsFunction())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
 
-    return result;
-}
+    streamDrainCallback = Napi::Persistent(info[0].As<Napi::Function>());
 
-SteamNetworkingMessage_t *networkingMessage;
+    return env.Undefined();
+}
 
-Napi::Value ReceiveMessagesOnChannel(const Napi::CallbackInfo &info)
+Napi::Value GetStreamStatus(const Napi::CallbackInfo &info)
 {
     Napi::Env env = info.Env();
 
-    // if (info.Length() < 1 || !info[0].IsNumber())
-    // {
-    //     THROW_BAD_ARGS("Bad arguments");
-    // }
+    if (info.Length() < 1 || !info[0].IsString() ||
+        (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsNumber()))
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
 
-    // uint32 length = info[0].ToNumber().Uint32Value();
+    uint64 peer = utils::strToUint64(info[0].ToString().Utf8Value());
+    int channel = info.Length() > 1 && info[1].IsNumber() ? info[1].ToNumber().Int32Value() : MESSAGE_CHANNEL;
 
-    // bool useProvidedArray = info.Length() > 1 && info[1].IsTypedArray();
+    ReliableStreams::Status status;
+    if (!reliableStreams.GetStatus(peer, channel, &status))
+    {
+        return env.Undefined();
+    }
 
-    // Napi::Uint8Array array;
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("queuedBytes", Napi::Number::New(env, static_cast<double>(status.queued_bytes)));
+    result.Set("queuedMessages", Napi::Number::New(env, status.queued_messages));
+    result.Set("pendingReliableBytes", Napi::Number::New(env, status.pending_reliable_bytes));
+    result.Set("pendingUnreliableBytes", Napi::Number::New(env, status.pending_unreliable_bytes));
+    result.Set("writable", Napi::Boolean::New(env, status.writable));
+    result.Set("sentBytes", Napi::Number::New(env, static_cast<double>(status.sent_bytes)));
+    result.Set("failedMessages", Napi::Number::New(env, static_cast<double>(status.failed_messages)));
+    result.Set("lastResult", Napi::Number::New(env, status.last_result));
 
-    // if (useProvidedArray)
-    // {
-    //     array = info[1].As<Napi::TypedArray>().As<Napi::Uint8Array>();
+    return result;
+}
 
-    //     if (array.ByteLength() < length)
-    //     {
-    //         THROW_BAD_ARGS("Bad arguments");
-    //     }
-    // }
-    // else
-    // {
+// Starts the voice thread. Decoded voice from any peer is passed to the callback; nothing is sent
+// until recording is switched on and targets are set. Returns the sample rate of the decoded audio.
+Napi::Value StartVoice(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsFunction())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    if (voiceChat.IsRunning())
+    {
+        voiceChat.Stop();
+        voiceWakeFunction.Release();
+    }
+
+    voiceCallback = Napi::Persistent(info[0].As<Napi::Function>());
+    voiceWakeFunction = Napi::ThreadSafeFunction::New(env, info[0].As<Napi::Function>(), "VoiceChat", 0, 1);
+    // Voice must not keep the process alive on its own.
+    voiceWakeFunction.Unref(env);
+
+    voiceChat.Start([]() {
+        voiceWakeFunction.NonBlockingCall([](Napi::Env env, Napi::Function) { FlushVoice(env); });
+    });
+
+    // Holds the most audio the voice thread buffers per peer, so one call always fits.
+    voiceSamples = Napi::Persistent(Napi::Float32Array::New(env, voiceChat.GetSampleRate()));
+
+    return Napi::Number::New(env, voiceChat.GetSampleRate());
+}
+
+Napi::Value StopVoice(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (voiceChat.IsRunning())
+    {
+        voiceChat.Stop();
+        voiceWakeFunction.Release();
+    }
+    voiceCallback.Reset();
+    voiceSamples.Reset();
+
+    return env.Undefined();
+}
+
+Napi::Value SetVoiceRecording(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsBoolean())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    if (!voiceChat.IsRunning())
+    {
+        THROW_BAD_ARGS("Voice is not started");
+        return env.Undefined();
+    }
+
+    voiceChat.SetRecording(info[0].ToBoolean());
+
+    return env.Undefined();
+}
+
+// Replaces the peers that captured voice is sent to.
+Napi::Value SetVoiceTargets(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsArray())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    Napi::Array steamIds = info[0].As<Napi::Array>();
+    std::vector<uint64> targets;
+    for (uint32 i = 0; i < steamIds.Length(); i++)
+    {
+        Napi::Value steamId = steamIds.Get(i);
+        if (!steamId.IsString())
+        {
+            THROW_BAD_ARGS("Bad arguments");
+            return env.Undefined();
+        }
+        targets.push_back(utils::strToUint64(steamId.ToString().Utf8Value()));
+    }
+    voiceTargets.swap(targets);
+
+    return env.Undefined();
+}
+
+Napi::Value GetVoiceStats(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    VoiceChat::Stats stats = voiceChat.GetStats();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("running", Napi::Boolean::New(env, voiceChat.IsRunning()));
+    result.Set("sampleRate", Napi::Number::New(env, voiceChat.GetSampleRate()));
+    result.Set("framesCaptured", Napi::Number::New(env, static_cast<double>(stats.frames_captured)));
+    result.Set("bytesCaptured", Napi::Number::New(env, static_cast<double>(stats.bytes_captured)));
+    result.Set("framesReceived", Napi::Number::New(env, static_cast<double>(stats.frames_received)));
+    result.Set("samplesDecoded", Napi::Number::New(env, static_cast<double>(stats.samples_decoded)));
+    result.Set("samplesDropped", Napi::Number::New(env, static_cast<double>(stats.samples_dropped)));
+    result.Set("decodeErrors", Napi::Number::New(env, static_cast<double>(stats.decode_errors)));
+
+    return result;
+}
+
+// Hands out a recycled native buffer for JS to fill and pass to sendMessageToUser (or a subarray of
+// it). Unlike a new Uint8Array it is not zeroed and does not grow the JS heap; it goes back to the
+// pool when collected.
+Napi::Value AcquireSendBuffer(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsNumber() || info[0].ToNumber().Int64Value() < 0)
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    size_t size = static_cast<size_t>(info[0].ToNumber().Int64Value());
+
+    size_t capacity;
+    uint8 *data = sendBufferPool.Acquire(size, &capacity);
+    if (data != nullptr)
+    {
+        Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(
+            env, data, capacity, [](Napi::Env, void *data) { sendBufferPool.Release(static_cast<uint8 *>(data)); });
+        if (!env.IsExceptionPending())
+        {
+            return Napi::Uint8Array::New(env, size, buffer, 0);
+        }
+
+        // Runtimes with the V8 sandbox enabled refuse external buffers.
+        env.GetAndClearPendingException();
+        sendBufferPool.Release(data);
+    }
+
+    unpooledSendBuffers++;
+    return Napi::Uint8Array::New(env, size);
+}
+
+Napi::Value GetSendBufferStats(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    MessageBufferPool::Stats stats = sendBufferPool.GetStats();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("allocations", Napi::Number::New(env, static_cast<double>(stats.allocations)));
+    result.Set("reuses", Napi::Number::New(env, static_cast<double>(stats.reuses)));
+    result.Set("outstanding", Napi::Number::New(env, static_cast<double>(stats.outstanding)));
+    result.Set("pooledBytes", Napi::Number::New(env, static_cast<double>(stats.pooled_bytes)));
+    result.Set("unpooled", Napi::Number::New(env, static_cast<double>(unpooledSendBuffers)));
+
+    return result;
+}
+
+Napi::Object GetSendRateObject(Napi::Env env, const SendRateController::PeerRate &rate)
+{
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("steamIdRemote", Napi::String::New(env, utils::uint64ToString(rate.peer)));
+    result.Set("budgetBytes", Napi::Number::New(env, rate.budget));
+    result.Set("rateBytesPerSecond", Napi::Number::New(env, rate.rate));
+    result.Set("ping", Napi::Number::New(env, rate.ping));
+    result.Set("quality", Napi::Number::New(env, rate.quality));
+    result.Set("pendingBytes", Napi::Number::New(env, rate.pending_bytes));
+    result.Set("queueTimeMs", Napi::Number::New(env, rate.queue_time / 1000.0));
+    return result;
+}
+
+// Per-peer payload budgets for the next tick. Peers are tracked from their first sendMessageToUser
+// until closeSessionWithUser and re-sampled on every runCallbacks.
+Napi::Value GetSendBudgets(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() > 0 && !info[0].IsUndefined() && !info[0].IsNumber())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    int tickMs = info.Length() > 0 && info[0].IsNumber() ? info[0].ToNumber().Int32Value()
+                                                          : DEFAULT_SEND_BUDGET_TICK_MS;
+
+    std::vector<uint64> peers = sendRateController.GetTrackedPeers();
+
+    Napi::Array result = Napi::Array::New(env, peers.size());
+    for (size_t i = 0; i < peers.size(); i++)
+    {
+        SendRateController::PeerRate rate;
+        sendRateController.GetRate(peers[i], tickMs, &rate);
+        result.Set(static_cast<uint32>(i), GetSendRateObject(env, rate));
+    }
+
+    return result;
+}
+
+Napi::Value GetSendBudget(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString() ||
+        (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsNumber()))
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    int tickMs = info.Length() > 1 && info[1].IsNumber() ? info[1].ToNumber().Int32Value()
+                                                          : DEFAULT_SEND_BUDGET_TICK_MS;
+
+    SendRateController::PeerRate rate;
+    if (!sendRateController.GetRate(utils::strToUint64(info[0].ToString().Utf8Value()), tickMs, &rate))
+    {
+        return env.Undefined();
+    }
+
+    return GetSendRateObject(env, rate);
+}
+
+Napi::Value CloseSessionWithUser(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+    }
+
+    std::string steamIdString = info[0].ToString().Utf8Value();
+
+    SteamNetworkingIdentity steamNetworkingIdentity;
+    steamNetworkingIdentity.SetSteamID64(utils::strToUint64(steamIdString));
+
+    bool result = GetNetworkingTransport()->CloseSessionWithUser(steamNetworkingIdentity);
+
+    ResetPeer(steamNetworkingIdentity.GetSteamID64());
+
+    return Napi::Boolean::New(env, result);
+}
+
+Napi::Value GetSessionConnectionInfo(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+    }
+
+    std::string steamIdString = info[0].ToString().Utf8Value();
+
+    SteamNetworkingIdentity steamNetworkingIdentity;
+    steamNetworkingIdentity.SetSteamID64(utils::strToUint64(steamIdString));
+
+    SteamNetConnectionInfo_t connectionInfo;
+    GetNetworkingTransport()->GetSessionConnectionInfo(steamNetworkingIdentity, &connectionInfo, nullptr);
+
+    Napi::Object result = Napi::Object::New(env);
+
+    result.Set("state", Napi::Number::New(env, connectionInfo.m_eState));
+    result.Set("endReason", Napi::Number::New(env, connectionInfo.m_eEndReason));
+    result.Set("connectionDescription", Napi::String::New(env, connectionInfo.m_szConnectionDescription));
+    result.Set("endDebug", Napi::String::New(env, connectionInfo.m_szEndDebug));
+
+    return result;
+}
+
+SteamNetworkingMessage_t *networkingMessage;
+
+Napi::Value ReceiveMessagesOnChannel(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    // if (info.Length() < 1 || !info[0].IsNumber())
+    // {
+    //     THROW_BAD_ARGS("Bad arguments");
+    // }
+
+    // uint32 length = info[0].ToNumber().Uint32Value();
+
+    // bool useProvidedArray = info.Length() > 1 && info[1].IsTypedArray();
+
+    // Napi::Uint8Array array;
+
+    // if (useProvidedArray)
+    // {
+    //     array = info[1].As<Napi::TypedArray>().As<Napi::Uint8Array>();
+
+    //     if (array.ByteLength() < length)
+    //     {
+    //         THROW_BAD_ARGS("Bad arguments");
+    //     }
+    // }
+    // else
+    // {
     //     array = Napi::Uint8Array::New(env, length);
     // }
 
@@ -1404,7 +2496,7 @@ Napi::Value ReceiveMessagesOnChannel(const Napi::CallbackInfo &info)
 
     SteamNetworkingMessage_t *messages[MAX_MESSAGES];
 
-    int messageCount = SteamNetworkingMessages()->ReceiveMessagesOnChannel(MESSAGE_CHANNEL, messages, MAX_MESSAGES);
+    int messageCount = GetNetworkingTransport()->ReceiveMessagesOnChannel(MESSAGE_CHANNEL, messages, MAX_MESSAGES);
     if (messageCount > 0)
     {
         Napi::Array result = Napi::Array::New(env, messageCount);
@@ -1413,28 +2505,657 @@ Napi::Value ReceiveMessagesOnChannel(const Napi::CallbackInfo &info)
         {
             SteamNetworkingMessage_t *message = messages[i];
 
-            auto steamIdRemote = Napi::String::New(env, utils::uint64ToString(message->m_identityPeer.GetSteamID64()));
-            auto array = Napi::Uint8Array::New(env, message->m_cbSize);
-            memcpy(array.Data(), message->GetData(), message->m_cbSize);
+            auto steamIdRemote = Napi::String::New(env, utils::uint64ToString(message->m_identityPeer.GetSteamID64()));
+            auto array = Napi::Uint8Array::New(env, message->m_cbSize);
+            memcpy(array.Data(), message->GetData(), message->m_cbSize);
+
+            Napi::Object messageJsObject = Napi::Object::New(env);
+            messageJsObject.Set("steamIdRemote", steamIdRemote);
+            messageJsObject.Set("data", array);
+
+            result.Set(i, messageJsObject);
+
+            message->Release();
+        }
+
+        // if (useProvidedArray)
+        // {
+        //     return steamIdRemoteString;
+        // }
+
+        return result;
+    }
+
+    return env.Undefined();
+}
+
+// Receives up to maxMessages messages in one struct-of-arrays batch: the payloads back to back in data
+// (message i is data[offsets[i]..offsets[i + 1]]) and the metadata in typed arrays, all views of a
+// single ArrayBuffer, so the cost does not grow with a JS object per message.
+Napi::Value ReceiveMessageBatch(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if ((info.Length() > 0 && !info[0].IsUndefined() && !info[0].IsNumber()) ||
+        (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsNumber()))
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    int channel = info.Length() > 0 && info[0].IsNumber() ? info[0].ToNumber().Int32Value() : MESSAGE_CHANNEL;
+    int maxMessages = info.Length() > 1 && info[1].IsNumber() ? info[1].ToNumber().Int32Value()
+                                                              : DEFAULT_MESSAGE_BATCH_SIZE;
+    if (!IsUserChannel(channel))
+    {
+        THROW_BAD_ARGS("Reserved channel");
+        return env.Undefined();
+    }
+    if (maxMessages <= 0)
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+    // Larger requests just take several calls; an unbounded allocation would abort the process.
+    maxMessages = std::min(maxMessages, MAX_MESSAGE_BATCH_SIZE);
+
+    std::vector<SteamNetworkingMessage_t *> messages(maxMessages);
+    int messageCount = GetNetworkingTransport()->ReceiveMessagesOnChannel(channel, messages.data(), maxMessages);
+    if (messageCount <= 0)
+    {
+        return env.Undefined();
+    }
+
+    size_t dataSize = 0;
+    for (int i = 0; i < messageCount; i++)
+    {
+        dataSize += messages[i]->m_cbSize;
+    }
+
+    // 8-byte columns first so every view is aligned.
+    size_t count = static_cast<size_t>(messageCount);
+    size_t timeReceivedOffset = 0;
+    size_t messageNumberOffset = timeReceivedOffset + count * sizeof(double);
+    size_t offsetsOffset = messageNumberOffset + count * sizeof(double);
+    size_t peerIndexOffset = offsetsOffset + (count + 1) * sizeof(uint32);
+    size_t channelOffset = peerIndexOffset + count * sizeof(uint32);
+    size_t flagsOffset = channelOffset + count * sizeof(int32);
+    size_t dataOffset = flagsOffset + count * sizeof(int32);
+
+    Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, dataOffset + dataSize);
+    Napi::Float64Array timeReceived = Napi::Float64Array::New(env, count, buffer, timeReceivedOffset);
+    Napi::Float64Array messageNumber = Napi::Float64Array::New(env, count, buffer, messageNumberOffset);
+    Napi::Uint32Array offsets = Napi::Uint32Array::New(env, count + 1, buffer, offsetsOffset);
+    Napi::Uint32Array peerIndex = Napi::Uint32Array::New(env, count, buffer, peerIndexOffset);
+    Napi::Int32Array channels = Napi::Int32Array::New(env, count, buffer, channelOffset);
+    Napi::Int32Array flags = Napi::Int32Array::New(env, count, buffer, flagsOffset);
+    Napi::Uint8Array data = Napi::Uint8Array::New(env, dataSize, buffer, dataOffset);
+
+    std::map<uint64, uint32> peerIndices;
+    Napi::Array peers = Napi::Array::New(env);
+    uint32 offset = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        SteamNetworkingMessage_t *message = messages[i];
+        uint64 peer = message->m_identityPeer.GetSteamID64();
+
+        auto index = peerIndices.find(peer);
+        if (index == peerIndices.end())
+        {
+            index = peerIndices.insert(std::make_pair(peer, static_cast<uint32>(peerIndices.size()))).first;
+            peers.Set(index->second, Napi::String::New(env, utils::uint64ToString(peer)));
+        }
+
+        timeReceived[i] = static_cast<double>(message->m_usecTimeReceived);
+        messageNumber[i] = static_cast<double>(message->m_nMessageNumber);
+        offsets[i] = offset;
+        peerIndex[i] = index->second;
+        channels[i] = message->m_nChannel;
+        flags[i] = message->m_nFlags;
+
+        memcpy(data.Data() + offset, message->GetData(), message->m_cbSize);
+        offset += message->m_cbSize;
+
+        message->Release();
+    }
+    offsets[count] = offset;
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("count", Napi::Number::New(env, messageCount));
+    result.Set("data", data);
+    result.Set("offsets", offsets);
+    result.Set("peers", peers);
+    result.Set("peerIndex", peerIndex);
+    result.Set("timeReceived", timeReceived);
+    result.Set("messageNumber", messageNumber);
+    result.Set("channel", channels);
+    result.Set("flags", flags);
+
+    return result;
+}
+
+Napi::Value SendSnapshot(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsTypedArray())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    uint64 steamIdRemote = utils::strToUint64(info[0].ToString().Utf8Value());
+
+    Napi::Uint8Array array = info[1].As<Napi::TypedArray>().As<Napi::Uint8Array>();
+    if (array.ByteLength() > SnapshotChannel::kMaxSnapshotSize)
+    {
+        THROW_BAD_ARGS("Snapshot too large");
+        return env.Undefined();
+    }
+
+    std::vector<uint8> packet;
+    uint32 sequence;
+    snapshotChannel.Encode(steamIdRemote, array.Data(), static_cast<uint32>(array.ByteLength()), &packet, &sequence);
+
+    SteamNetworkingIdentity steamNetworkingIdentity;
+    steamNetworkingIdentity.SetSteamID64(steamIdRemote);
+
+    // Snapshots supersede each other, so they go unreliable; losses are repaired by the next keyframe.
+    EResult result = GetNetworkingTransport()->SendMessageToUser(
+        steamNetworkingIdentity, packet.data(), static_cast<uint32>(packet.size()),
+        k_nSteamNetworkingSend_UnreliableNoNagle | k_nSteamNetworkingSend_AutoRestartBrokenSession, SNAPSHOT_CHANNEL);
+
+    return Napi::Number::New(env, result);
+}
+
+Napi::Value ReceiveSnapshots(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    SteamNetworkingMessage_t *messages[MAX_MESSAGES];
+
+    int messageCount = GetNetworkingTransport()->ReceiveMessagesOnChannel(SNAPSHOT_CHANNEL, messages, MAX_MESSAGES);
+    if (messageCount <= 0)
+    {
+        return env.Undefined();
+    }
+
+    Napi::Array result = Napi::Array::New(env);
+    uint32 resultCount = 0;
+
+    std::vector<uint8> snapshot;
+    std::vector<uint8> ack;
+
+    for (int i = 0; i < messageCount; i++)
+    {
+        SteamNetworkingMessage_t *message = messages[i];
+        uint64 steamIdRemote = message->m_identityPeer.GetSteamID64();
+
+        uint32 sequence;
+        if (snapshotChannel.Decode(steamIdRemote, static_cast<const uint8 *>(message->GetData()),
+                                   static_cast<uint32>(message->m_cbSize), &snapshot, &sequence, &ack))
+        {
+            GetNetworkingTransport()->SendMessageToUser(message->m_identityPeer, ack.data(),
+                                                        static_cast<uint32>(ack.size()),
+                                                        k_nSteamNetworkingSend_UnreliableNoNagle, SNAPSHOT_CHANNEL);
+
+            auto array = Napi::Uint8Array::New(env, snapshot.size());
+            memcpy(array.Data(), snapshot.data(), snapshot.size());
+
+            Napi::Object snapshotJsObject = Napi::Object::New(env);
+            snapshotJsObject.Set("steamIdRemote", Napi::String::New(env, utils::uint64ToString(steamIdRemote)));
+            snapshotJsObject.Set("sequence", Napi::Number::New(env, sequence));
+            snapshotJsObject.Set("data", array);
+
+            result.Set(resultCount++, snapshotJsObject);
+        }
+
+        message->Release();
+    }
+
+    if (resultCount == 0)
+    {
+        return env.Undefined();
+    }
+
+    return result;
+}
+
+Napi::Value ResetSnapshotPeer(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    snapshotChannel.ResetPeer(utils::strToUint64(info[0].ToString().Utf8Value()));
+
+    return env.Undefined();
+}
+
+Napi::Value GetSnapshotStats(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    const SnapshotChannel::Stats &stats = snapshotChannel.GetStats();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("keyframesSent", Napi::Number::New(env, static_cast<double>(stats.keyframes_sent)));
+    result.Set("deltasSent", Napi::Number::New(env, static_cast<double>(stats.deltas_sent)));
+    result.Set("snapshotBytes", Napi::Number::New(env, static_cast<double>(stats.snapshot_bytes)));
+    result.Set("encodedBytes", Napi::Number::New(env, static_cast<double>(stats.encoded_bytes)));
+    result.Set("snapshotsReceived", Napi::Number::New(env, static_cast<double>(stats.snapshots_received)));
+    result.Set("snapshotsDropped", Napi::Number::New(env, static_cast<double>(stats.snapshots_dropped)));
+
+    return result;
+}
+
+Napi::Value QueueStateUpdate(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 3 || !info[0].IsString() || !info[1].IsNumber() || !info[2].IsTypedArray())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    Napi::Uint8Array array = info[2].As<Napi::TypedArray>().As<Napi::Uint8Array>();
+    if (array.ByteLength() > StateChannel::kMaxUpdateSize)
+    {
+        THROW_BAD_ARGS("State update too large");
+        return env.Undefined();
+    }
+
+    stateChannel.Queue(utils::strToUint64(info[0].ToString().Utf8Value()), info[1].ToNumber().Uint32Value(),
+                       array.Data(), static_cast<uint32>(array.ByteLength()));
+
+    return env.Undefined();
+}
+
+Napi::Value FlushStateUpdates(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() > 0 && !info[0].IsUndefined() && !info[0].IsNumber())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    uint32 maxBytesPerPeer = info.Length() > 0 && info[0].IsNumber() ? info[0].ToNumber().Uint32Value() : 0;
+
+    std::vector<std::pair<uint64, std::vector<uint8>>> packets;
+    stateChannel.Flush(maxBytesPerPeer, &packets);
+
+    for (const auto &packet : packets)
+    {
+        SteamNetworkingIdentity steamNetworkingIdentity;
+        steamNetworkingIdentity.SetSteamID64(packet.first);
+
+        // Stale state is worthless, so updates go unreliable; the next update for a key repairs a loss.
+        GetNetworkingTransport()->SendMessageToUser(
+            steamNetworkingIdentity, packet.second.data(), static_cast<uint32>(packet.second.size()),
+            k_nSteamNetworkingSend_UnreliableNoNagle | k_nSteamNetworkingSend_AutoRestartBrokenSession,
+            STATE_CHANNEL);
+    }
+
+    return Napi::Number::New(env, static_cast<double>(packets.size()));
+}
+
+Napi::Value ReceiveStateUpdates(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    SteamNetworkingMessage_t *messages[MAX_MESSAGES];
+
+    int messageCount = GetNetworkingTransport()->ReceiveMessagesOnChannel(STATE_CHANNEL, messages, MAX_MESSAGES);
+    if (messageCount <= 0)
+    {
+        return env.Undefined();
+    }
+
+    Napi::Array result = Napi::Array::New(env);
+    uint32 resultCount = 0;
+
+    std::vector<StateChannel::Update> updates;
+
+    for (int i = 0; i < messageCount; i++)
+    {
+        SteamNetworkingMessage_t *message = messages[i];
+        uint64 steamIdRemote = message->m_identityPeer.GetSteamID64();
+
+        updates.clear();
+        stateChannel.Decode(steamIdRemote, static_cast<const uint8 *>(message->GetData()),
+                            static_cast<uint32>(message->m_cbSize), &updates);
+
+        if (!updates.empty())
+        {
+            Napi::String steamIdString = Napi::String::New(env, utils::uint64ToString(steamIdRemote));
+
+            for (const StateChannel::Update &update : updates)
+            {
+                auto array = Napi::Uint8Array::New(env, update.size);
+                memcpy(array.Data(), update.data, update.size);
+
+                Napi::Object updateJsObject = Napi::Object::New(env);
+                updateJsObject.Set("steamIdRemote", steamIdString);
+                updateJsObject.Set("key", Napi::Number::New(env, update.key));
+                updateJsObject.Set("sequence", Napi::Number::New(env, update.sequence));
+                updateJsObject.Set("data", array);
+
+                result.Set(resultCount++, updateJsObject);
+            }
+        }
+
+        message->Release();
+    }
+
+    if (resultCount == 0)
+    {
+        return env.Undefined();
+    }
+
+    return result;
+}
+
+Napi::Value GetStateChannelStats(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    const StateChannel::Stats &stats = stateChannel.GetStats();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("updatesQueued", Napi::Number::New(env, static_cast<double>(stats.updates_queued)));
+    result.Set("updatesReplaced", Napi::Number::New(env, static_cast<double>(stats.updates_replaced)));
+    result.Set("updatesSent", Napi::Number::New(env, static_cast<double>(stats.updates_sent)));
+    result.Set("packetsSent", Napi::Number::New(env, static_cast<double>(stats.packets_sent)));
+    result.Set("bytesSent", Napi::Number::New(env, static_cast<double>(stats.bytes_sent)));
+    result.Set("updatesReceived", Napi::Number::New(env, static_cast<double>(stats.updates_received)));
+    result.Set("updatesDropped", Napi::Number::New(env, static_cast<double>(stats.updates_dropped)));
+
+    return result;
+}
+
+int GetTimedMessageChannel(const Napi::CallbackInfo &info, size_t index)
+{
+    return info.Length() > index && info[index].IsNumber() ? info[index].ToNumber().Int32Value()
+                                                           : TIMED_MESSAGE_CHANNEL;
+}
+
+// Sends |data| stamped with the local time for the remote jitter buffer.
+Napi::Value SendTimedMessage(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsTypedArray() ||
+        (info.Length() > 2 && !info[2].IsUndefined() && !info[2].IsNumber()))
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    int channel = GetTimedMessageChannel(info, 2);
+    if (channel != TIMED_MESSAGE_CHANNEL && !IsUserChannel(channel))
+    {
+        THROW_BAD_ARGS("Reserved channel");
+        return env.Undefined();
+    }
+
+    Napi::Uint8Array array = info[1].As<Napi::TypedArray>().As<Napi::Uint8Array>();
+
+    std::vector<uint8> packet(JitterBuffer::kHeaderSize + array.ByteLength());
+    JitterBuffer::WriteHeader(GetNetworkingTransport()->GetLocalTimestamp(), packet.data());
+    memcpy(packet.data() + JitterBuffer::kHeaderSize, array.Data(), array.ByteLength());
+
+    SteamNetworkingIdentity steamNetworkingIdentity;
+    steamNetworkingIdentity.SetSteamID64(utils::strToUint64(info[0].ToString().Utf8Value()));
+
+    EResult result = GetNetworkingTransport()->SendMessageToUser(
+        steamNetworkingIdentity, packet.data(), static_cast<uint32>(packet.size()),
+        k_nSteamNetworkingSend_UnreliableNoNagle | k_nSteamNetworkingSend_AutoRestartBrokenSession, channel);
+
+    return Napi::Number::New(env, result);
+}
+
+// Moves everything waiting on the channel into the per-peer jitter buffers and returns the messages
+// whose playout time has come, in sender order per peer.
+Napi::Value ReceiveTimedMessages(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() > 0 && !info[0].IsUndefined() && !info[0].IsNumber())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    int channel = GetTimedMessageChannel(info, 0);
+    if (channel != TIMED_MESSAGE_CHANNEL && !IsUserChannel(channel))
+    {
+        THROW_BAD_ARGS("Reserved channel");
+        return env.Undefined();
+    }
+
+    NetworkingTransport *transport = GetNetworkingTransport();
+
+    SteamNetworkingMessage_t *messages[MAX_MESSAGES];
+    int messageCount;
+    while ((messageCount = transport->ReceiveMessagesOnChannel(channel, messages, MAX_MESSAGES)) > 0)
+    {
+        for (int i = 0; i < messageCount; i++)
+        {
+            uint64 steamIdRemote = messages[i]->m_identityPeer.GetSteamID64();
+            jitterBuffers[std::make_pair(steamIdRemote, channel)].Push(messages[i]);
+        }
+    }
+
+    SteamNetworkingMicroseconds now = transport->GetLocalTimestamp();
+
+    Napi::Array result = Napi::Array::New(env);
+    uint32 resultCount = 0;
+
+    for (auto &jitterBuffer : jitterBuffers)
+    {
+        if (jitterBuffer.first.second != channel)
+        {
+            continue;
+        }
+
+        Napi::String steamIdString;
+        SteamNetworkingMicroseconds senderTime;
+        while (SteamNetworkingMessage_t *message = jitterBuffer.second.Pop(now, &senderTime))
+        {
+            if (steamIdString.IsEmpty())
+            {
+                steamIdString = Napi::String::New(env, utils::uint64ToString(jitterBuffer.first.first));
+            }
+
+            const uint8 *payload = static_cast<const uint8 *>(message->GetData()) + JitterBuffer::kHeaderSize;
+            uint32 size = static_cast<uint32>(message->m_cbSize) - JitterBuffer::kHeaderSize;
+            auto array = Napi::Uint8Array::New(env, size);
+            memcpy(array.Data(), payload, size);
+            message->Release();
+
+            Napi::Object messageJsObject = Napi::Object::New(env);
+            messageJsObject.Set("steamIdRemote", steamIdString);
+            messageJsObject.Set("senderTime", Napi::Number::New(env, static_cast<double>(senderTime)));
+            messageJsObject.Set("data", array);
+
+            result.Set(resultCount++, messageJsObject);
+        }
+    }
+
+    if (resultCount == 0)
+    {
+        return env.Undefined();
+    }
+
+    return result;
+}
+
+Napi::Value GetJitterBufferStats(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString() ||
+        (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsNumber()))
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    auto jitterBuffer = jitterBuffers.find(
+        std::make_pair(utils::strToUint64(info[0].ToString().Utf8Value()), GetTimedMessageChannel(info, 1)));
+    if (jitterBuffer == jitterBuffers.end())
+    {
+        return env.Undefined();
+    }
+
+    JitterBuffer::Stats stats = jitterBuffer->second.GetStats();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("received", Napi::Number::New(env, static_cast<double>(stats.received)));
+    result.Set("delivered", Napi::Number::New(env, static_cast<double>(stats.delivered)));
+    result.Set("late", Napi::Number::New(env, static_cast<double>(stats.late)));
+    result.Set("dropped", Napi::Number::New(env, static_cast<double>(stats.dropped)));
+    result.Set("buffered", Napi::Number::New(env, stats.buffered));
+    result.Set("jitterMs", Napi::Number::New(env, stats.jitter / 1000.0));
+    result.Set("depthMs", Napi::Number::New(env, stats.depth / 1000.0));
+
+    return result;
+}
+
+Napi::Value StartClockSync(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    clockSync.Start(utils::strToUint64(info[0].ToString().Utf8Value()));
+
+    return env.Undefined();
+}
+
+Napi::Value StopClockSync(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    clockSync.Stop(utils::strToUint64(info[0].ToString().Utf8Value()));
+
+    return env.Undefined();
+}
+
+// Returns the peer's clock relative to ours, or undefined until the first answer has arrived.
+Napi::Value GetClockSync(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    ClockSync::Estimate estimate;
+    if (!clockSync.GetEstimate(utils::strToUint64(info[0].ToString().Utf8Value()), &estimate))
+    {
+        return env.Undefined();
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("offsetMs", Napi::Number::New(env, estimate.offset / 1000.0));
+    result.Set("rttMs", Napi::Number::New(env, estimate.rtt / 1000.0));
+    result.Set("samples", Napi::Number::New(env, estimate.samples));
+
+    return result;
+}
+
+Napi::Value PrewarmSessions(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsArray())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    Napi::Array steamIds = info[0].As<Napi::Array>();
+    for (uint32 i = 0; i < steamIds.Length(); i++)
+    {
+        Napi::Value steamId = steamIds.Get(i);
+        if (!steamId.IsString())
+        {
+            THROW_BAD_ARGS("Bad arguments");
+            return env.Undefined();
+        }
+        sessionPool.Prewarm(utils::strToUint64(steamId.ToString().Utf8Value()));
+    }
+
+    return env.Undefined();
+}
+
+Napi::Value SetSessionPoolOptions(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    sessionPool.SetTimeouts(info[0].ToNumber().Int32Value(), info[1].ToNumber().Int32Value());
+
+    return env.Undefined();
+}
+
+Napi::Value SetSessionPoolCallback(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
 
-            Napi::Object messageJsObject = Napi::Object::New(env);
-            messageJsObject.Set("steamIdRemote", steamIdRemote);
-            messageJsObject.Set("data", array);
+    if (info.Length() < 1 || !info[0].IsFunction())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
 
-            result.Set(i, messageJsObject);
+    sessionPoolCallback = Napi::Persistent(info[0].As<Napi::Function>());
 
-            message->Release();
-        }
+    return env.Undefined();
+}
 
-        // if (useProvidedArray)
-        // {
-        //     return steamIdRemoteString;
-        // }
+Napi::Value GetSessionPoolStatus(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
 
-        return result;
+    std::vector<SessionPool::PeerStatus> status = sessionPool.GetStatus();
+
+    Napi::Array result = Napi::Array::New(env, status.size());
+    for (size_t i = 0; i < status.size(); i++)
+    {
+        Napi::Object peer = Napi::Object::New(env);
+        peer.Set("steamIdRemote", Napi::String::New(env, utils::uint64ToString(status[i].peer)));
+        peer.Set("state", Napi::Number::New(env, status[i].state));
+        peer.Set("warmUpMs", Napi::Number::New(env, static_cast<double>(status[i].warm_up_ms)));
+        result.Set(static_cast<uint32>(i), peer);
     }
 
-    return env.Undefined();
+    return result;
 }
 
 Napi::Value SetSteamNetworkingMessagesSessionRequestCallback(const Napi::CallbackInfo &info)
@@ -1513,6 +3234,93 @@ Napi::Value SetSteamNetworkingSendRates(const Napi::CallbackInfo &info)
     return env.Undefined();
 }
 
+// The Connection scope takes an HSteamNetConnection. ISteamNetworkingMessages sessions do not expose
+// theirs, so they pick up the global values when the session is created.
+Napi::Value SetConfigValue(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsNumber() ||
+        (info.Length() > 2 && !info[2].IsUndefined() && !info[2].IsNumber()))
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    ESteamNetworkingConfigValue value;
+    ESteamNetworkingConfigDataType type;
+    if (!utils::GetNetworkingConfigValue(info[0].ToString().Utf8Value(), &value, &type))
+    {
+        THROW_BAD_ARGS("Unknown config value");
+        return env.Undefined();
+    }
+
+    bool perConnection = info.Length() > 2 && info[2].IsNumber();
+    ESteamNetworkingConfigScope scope =
+        perConnection ? k_ESteamNetworkingConfig_Connection : k_ESteamNetworkingConfig_Global;
+    intptr_t scopeObject = perConnection ? static_cast<intptr_t>(info[2].ToNumber().Uint32Value()) : 0;
+
+    bool result;
+    if (type == k_ESteamNetworkingConfig_Float)
+    {
+        float data = info[1].ToNumber().FloatValue();
+        result = SteamNetworkingUtils()->SetConfigValue(value, scope, scopeObject, type, &data);
+    }
+    else
+    {
+        int32 data = info[1].ToNumber().Int32Value();
+        result = SteamNetworkingUtils()->SetConfigValue(value, scope, scopeObject, type, &data);
+    }
+
+    return Napi::Boolean::New(env, result);
+}
+
+Napi::Value GetConfigValue(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString() ||
+        (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsNumber()))
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    ESteamNetworkingConfigValue value;
+    ESteamNetworkingConfigDataType type;
+    if (!utils::GetNetworkingConfigValue(info[0].ToString().Utf8Value(), &value, &type))
+    {
+        THROW_BAD_ARGS("Unknown config value");
+        return env.Undefined();
+    }
+
+    bool perConnection = info.Length() > 1 && info[1].IsNumber();
+    ESteamNetworkingConfigScope scope =
+        perConnection ? k_ESteamNetworkingConfig_Connection : k_ESteamNetworkingConfig_Global;
+    intptr_t scopeObject = perConnection ? static_cast<intptr_t>(info[1].ToNumber().Uint32Value()) : 0;
+
+    // Both exposed types are 4 bytes wide.
+    uint8 data[4];
+    size_t size = sizeof(data);
+    ESteamNetworkingGetConfigValueResult result =
+        SteamNetworkingUtils()->GetConfigValue(value, scope, scopeObject, &type, data, &size);
+    if (result != k_ESteamNetworkingGetConfigValue_OK && result != k_ESteamNetworkingGetConfigValue_OKInherited)
+    {
+        return env.Undefined();
+    }
+
+    if (type == k_ESteamNetworkingConfig_Float)
+    {
+        float floatValue;
+        memcpy(&floatValue, data, sizeof(floatValue));
+        return Napi::Number::New(env, floatValue);
+    }
+
+    int32 int32Value;
+    memcpy(&int32Value, data, sizeof(int32Value));
+    return Napi::Number::New(env, int32Value);
+}
+
 // Napi::Value SetSteamNetworkingConnectionStatusCallback(const Napi::CallbackInfo &info)
 // {
 //     Napi::Env env = info.Env();
@@ -1648,7 +3456,7 @@ Napi::Value AcceptP2PSessionWithUser(const Napi::CallbackInfo &info)
     std::string steamIdString = info[0].ToString().Utf8Value();
     CSteamID steamIdRemote(utils::strToUint64(steamIdString));
 
-    bool success = SteamNetworking()->AcceptP2PSessionWithUser(steamIdRemote);
+    bool success = GetNetworkingTransport()->AcceptP2PSessionWithUser(steamIdRemote);
 
     return Napi::Boolean::New(env, success);
 }
@@ -1669,7 +3477,7 @@ Napi::Value SendP2PPacket(const Napi::CallbackInfo &info)
     uint8_t *dst = array.Data();
     uint32 length = sizeof(uint8_t) * array.ByteLength();
 
-    bool sent = SteamNetworking()->SendP2PPacket(steamIdRemote, dst, length, EP2PSend::k_EP2PSendReliable);
+    bool sent = GetNetworkingTransport()->SendP2PPacket(steamIdRemote, dst, length, EP2PSend::k_EP2PSendReliable);
 
     return Napi::Boolean::New(env, sent);
 }
@@ -1679,7 +3487,7 @@ Napi::Value IsP2PPacketAvailable(const Napi::CallbackInfo &info)
     Napi::Env env = info.Env();
 
     uint32 messageSize;
-    bool result = SteamNetworking()->IsP2PPacketAvailable(&messageSize);
+    bool result = GetNetworkingTransport()->IsP2PPacketAvailable(&messageSize);
     if (result && messageSize > 0)
     {
         return Napi::Number::New(env, messageSize);
@@ -1724,7 +3532,7 @@ Napi::Value ReadP2PPacket(const Napi::CallbackInfo &info)
 
     uint32 packetSize;
     CSteamID steamIdRemote;
-    bool success = SteamNetworking()->ReadP2PPacket(dst, sizeof(uint8_t) * length, &packetSize, &steamIdRemote);
+    bool success = GetNetworkingTransport()->ReadP2PPacket(dst, sizeof(uint8_t) * length, &packetSize, &steamIdRemote);
     if (success)
     {
         auto steamIdRemoteString = Napi::String::New(env, utils::uint64ToString(steamIdRemote.ConvertToUint64()));
@@ -1760,7 +3568,7 @@ Napi::Value GetP2PSessionState(const Napi::CallbackInfo &info)
     CSteamID steamIdRemote(utils::strToUint64(steamIdString));
 
     P2PSessionState_t sessionState;
-    bool success = SteamNetworking()->GetP2PSessionState(steamIdRemote, &sessionState);
+    bool success = GetNetworkingTransport()->GetP2PSessionState(steamIdRemote, &sessionState);
     if (success)
     {
         Napi::Object result = Napi::Object::New(env);
@@ -1788,11 +3596,303 @@ Napi::Value CloseP2PSessionWithUser(const Napi::CallbackInfo &info)
     std::string steamIdString = info[0].ToString().Utf8Value();
     CSteamID steamIdRemote(utils::strToUint64(steamIdString));
 
-    bool result = SteamNetworking()->CloseP2PSessionWithUser(steamIdRemote);
+    bool result = GetNetworkingTransport()->CloseP2PSessionWithUser(steamIdRemote);
 
     return Napi::Boolean::New(env, result);
 }
 
+bool ParseLoopbackLinkConfig(const Napi::Value &value, LoopbackLinkConfig *config)
+{
+    if (!value.IsObject())
+    {
+        return false;
+    }
+
+    Napi::Object object = value.As<Napi::Object>();
+    config->latency_ms = 0;
+    config->jitter_ms = 0;
+    config->loss = 0;
+    config->bandwidth = 0;
+
+    if (object.Has("latencyMs"))
+    {
+        config->latency_ms = object.Get("latencyMs").ToNumber().Int32Value();
+    }
+    if (object.Has("jitterMs"))
+    {
+        config->jitter_ms = object.Get("jitterMs").ToNumber().Int32Value();
+    }
+    if (object.Has("loss"))
+    {
+        config->loss = object.Get("loss").ToNumber().DoubleValue();
+    }
+    if (object.Has("bandwidth"))
+    {
+        config->bandwidth = object.Get("bandwidth").ToNumber().Int32Value();
+    }
+
+    return config->latency_ms >= 0 && config->jitter_ms >= 0 && config->loss >= 0 && config->loss <= 1 &&
+           config->bandwidth >= 0;
+}
+
+Napi::Value EnableLoopback(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    LoopbackLinkConfig config = {0, 0, 0, 0};
+    if (info.Length() > 0 && !info[0].IsUndefined() && !ParseLoopbackLinkConfig(info[0], &config))
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    if (loopbackNetwork)
+    {
+        THROW_BAD_ARGS("Loopback is already enabled");
+        return env.Undefined();
+    }
+
+    loopbackNetwork.reset(new LoopbackNetwork(config));
+    LoopbackTransport *peer = loopbackNetwork->CreatePeer();
+    SetNetworkingTransport(peer);
+
+    return Napi::String::New(env, utils::uint64ToString(peer->GetSteamID64()));
+}
+
+Napi::Value DisableLoopback(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    SetNetworkingTransport(nullptr);
+    loopbackNetwork.reset();
+
+    return env.Undefined();
+}
+
+Napi::Value CreateLoopbackPeer(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (!loopbackNetwork)
+    {
+        THROW_BAD_ARGS("Loopback is not enabled");
+        return env.Undefined();
+    }
+
+    LoopbackTransport *peer = loopbackNetwork->CreatePeer();
+    if (peer == nullptr)
+    {
+        THROW_BAD_ARGS("Too many loopback peers");
+        return env.Undefined();
+    }
+
+    return Napi::String::New(env, utils::uint64ToString(peer->GetSteamID64()));
+}
+
+Napi::Value SetLoopbackActivePeer(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    if (!loopbackNetwork)
+    {
+        THROW_BAD_ARGS("Loopback is not enabled");
+        return env.Undefined();
+    }
+
+    LoopbackTransport *peer = loopbackNetwork->FindPeer(utils::strToUint64(info[0].ToString().Utf8Value()));
+    if (peer == nullptr)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    SetNetworkingTransport(peer);
+
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value SetLoopbackLinkConfig(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    LoopbackLinkConfig config;
+    if (info.Length() < 1 || !ParseLoopbackLinkConfig(info[0], &config) ||
+        (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsString()))
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    if (!loopbackNetwork)
+    {
+        THROW_BAD_ARGS("Loopback is not enabled");
+        return env.Undefined();
+    }
+
+    if (info.Length() > 1 && info[1].IsString())
+    {
+        LoopbackTransport *peer = loopbackNetwork->FindPeer(utils::strToUint64(info[1].ToString().Utf8Value()));
+        if (peer == nullptr)
+        {
+            return Napi::Boolean::New(env, false);
+        }
+        peer->SetLinkConfig(config);
+    }
+    else
+    {
+        loopbackNetwork->SetLinkConfig(config);
+    }
+
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value GetLoopbackStats(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (!loopbackNetwork)
+    {
+        return env.Undefined();
+    }
+
+    const LoopbackNetwork::Stats &stats = loopbackNetwork->GetStats();
+    uint64 delivered = stats.messages_delivered.load();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("messagesSent", Napi::Number::New(env, static_cast<double>(stats.messages_sent.load())));
+    result.Set("messagesDelivered", Napi::Number::New(env, static_cast<double>(delivered)));
+    result.Set("messagesDropped", Napi::Number::New(env, static_cast<double>(stats.messages_dropped.load())));
+    result.Set("bytesSent", Napi::Number::New(env, static_cast<double>(stats.bytes_sent.load())));
+    result.Set("bytesDelivered", Napi::Number::New(env, static_cast<double>(stats.bytes_delivered.load())));
+    result.Set("averageLatencyMs",
+               Napi::Number::New(env, delivered > 0 ? stats.latency_us.load() / 1000.0 / delivered : 0));
+
+    return result;
+}
+
+Napi::Value StartCapture(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString())
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    if (GetNetworkingTransportLayer() != nullptr)
+    {
+        THROW_BAD_ARGS("A capture or replay is already running");
+        return env.Undefined();
+    }
+
+    std::unique_ptr<CaptureWriter> writer(new CaptureWriter());
+    if (!writer->Open(info[0].ToString().Utf8Value()))
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    captureWriter = std::move(writer);
+    captureTransport.reset(new CaptureTransport(captureWriter.get()));
+    SetNetworkingTransportLayer(captureTransport.get());
+
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value StopCapture(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (!captureTransport)
+    {
+        return env.Undefined();
+    }
+
+    SetNetworkingTransportLayer(nullptr);
+    captureWriter->Close();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("records", Napi::Number::New(env, static_cast<double>(captureWriter->GetRecordCount())));
+    result.Set("bytes", Napi::Number::New(env, static_cast<double>(captureWriter->GetByteCount())));
+
+    captureTransport.reset();
+    captureWriter.reset();
+
+    return result;
+}
+
+Napi::Value StartReplay(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString() ||
+        (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsNumber()))
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    double speed = info.Length() > 1 && info[1].IsNumber() ? info[1].ToNumber().DoubleValue() : 1;
+    if (speed < 0)
+    {
+        THROW_BAD_ARGS("Bad arguments");
+        return env.Undefined();
+    }
+
+    if (GetNetworkingTransportLayer() != nullptr)
+    {
+        THROW_BAD_ARGS("A capture or replay is already running");
+        return env.Undefined();
+    }
+
+    std::unique_ptr<CaptureReader> reader(new CaptureReader());
+    if (!reader->Open(info[0].ToString().Utf8Value()))
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    replayReader = std::move(reader);
+    replayTransport.reset(new ReplayTransport(replayReader.get(), speed));
+    SetNetworkingTransportLayer(replayTransport.get());
+
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value StopReplay(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (replayTransport)
+    {
+        SetNetworkingTransportLayer(nullptr);
+        replayTransport.reset();
+        replayReader.reset();
+    }
+
+    return env.Undefined();
+}
+
+Napi::Value GetReplayStatus(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (!replayTransport)
+    {
+        return env.Undefined();
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("replayed", Napi::Number::New(env, static_cast<double>(replayTransport->GetReplayedCount())));
+    result.Set("finished", Napi::Boolean::New(env, replayTransport->IsFinished()));
+
+    return result;
+}
+
 void InitUtilsObject(Napi::Env env, Napi::Object exports)
 {
     // Prepare constructor template
@@ -1811,19 +3911,60 @@ void InitNetworkingObject(Napi::Env env, Napi::Object exports)
 
     SET_FUNCTION_TPL("initRelayNetworkAccess", InitRelayNetworkAccess);
     SET_FUNCTION_TPL("getRelayNetworkStatus", GetRelayNetworkStatus);
+    SET_FUNCTION_TPL("getLocalPingLocation", GetLocalPingLocation);
+    SET_FUNCTION_TPL("isValidPingLocation", IsValidPingLocation);
+    SET_FUNCTION_TPL("estimatePingTimeBetweenTwoLocations", EstimatePingTimeBetweenTwoLocations);
+    SET_FUNCTION_TPL("estimatePingTimeFromLocalHost", EstimatePingTimeFromLocalHost);
+    SET_FUNCTION_TPL("getLobbyPingMatrix", GetLobbyPingMatrix);
+    SET_FUNCTION_TPL("waitForRelayNetwork", WaitForRelayNetwork);
+    SET_FUNCTION_TPL("setRelayNetworkStatusCallback", SetRelayNetworkStatusCallback);
 
     // new
     SET_FUNCTION_TPL("acceptSessionWithUser", AcceptSessionWithUser);
     SET_FUNCTION_TPL("sendMessageToUser", SendMessageToUser);
+    SET_FUNCTION_TPL("acquireSendBuffer", AcquireSendBuffer);
+    SET_FUNCTION_TPL("getSendBufferStats", GetSendBufferStats);
+    SET_FUNCTION_TPL("getSendBudgets", GetSendBudgets);
+    SET_FUNCTION_TPL("getSendBudget", GetSendBudget);
     SET_FUNCTION_TPL("closeSessionWithUser", CloseSessionWithUser);
     SET_FUNCTION_TPL("getSessionConnectionInfo", GetSessionConnectionInfo);
     SET_FUNCTION_TPL("receiveMessagesOnChannel", ReceiveMessagesOnChannel);
+    SET_FUNCTION_TPL("receiveMessageBatch", ReceiveMessageBatch);
+    SET_FUNCTION_TPL("writeStream", WriteStream);
+    SET_FUNCTION_TPL("setStreamOptions", SetStreamOptions);
+    SET_FUNCTION_TPL("setStreamDrainCallback", SetStreamDrainCallback);
+    SET_FUNCTION_TPL("getStreamStatus", GetStreamStatus);
+    SET_FUNCTION_TPL("startVoice", StartVoice);
+    SET_FUNCTION_TPL("stopVoice", StopVoice);
+    SET_FUNCTION_TPL("setVoiceRecording", SetVoiceRecording);
+    SET_FUNCTION_TPL("setVoiceTargets", SetVoiceTargets);
+    SET_FUNCTION_TPL("getVoiceStats", GetVoiceStats);
+    SET_FUNCTION_TPL("sendSnapshot", SendSnapshot);
+    SET_FUNCTION_TPL("receiveSnapshots", ReceiveSnapshots);
+    SET_FUNCTION_TPL("resetSnapshotPeer", ResetSnapshotPeer);
+    SET_FUNCTION_TPL("getSnapshotStats", GetSnapshotStats);
+    SET_FUNCTION_TPL("queueStateUpdate", QueueStateUpdate);
+    SET_FUNCTION_TPL("flushStateUpdates", FlushStateUpdates);
+    SET_FUNCTION_TPL("receiveStateUpdates", ReceiveStateUpdates);
+    SET_FUNCTION_TPL("getStateChannelStats", GetStateChannelStats);
+    SET_FUNCTION_TPL("sendTimedMessage", SendTimedMessage);
+    SET_FUNCTION_TPL("receiveTimedMessages", ReceiveTimedMessages);
+    SET_FUNCTION_TPL("getJitterBufferStats", GetJitterBufferStats);
+    SET_FUNCTION_TPL("startClockSync", StartClockSync);
+    SET_FUNCTION_TPL("stopClockSync", StopClockSync);
+    SET_FUNCTION_TPL("getClockSync", GetClockSync);
+    SET_FUNCTION_TPL("prewarmSessions", PrewarmSessions);
+    SET_FUNCTION_TPL("setSessionPoolOptions", SetSessionPoolOptions);
+    SET_FUNCTION_TPL("setSessionPoolCallback", SetSessionPoolCallback);
+    SET_FUNCTION_TPL("getSessionPoolStatus", GetSessionPoolStatus);
     SET_FUNCTION_TPL("setSteamNetworkingMessagesSessionRequestCallback",
                      SetSteamNetworkingMessagesSessionRequestCallback);
     SET_FUNCTION_TPL("setSteamNetworkingMessagesSessionFailedCallback",
                      SetSteamNetworkingMessagesSessionFailedCallback);
     // SET_FUNCTION_TPL("setSteamNetworkingConnectionStatusCallback", SetSteamNetworkingConnectionStatusCallback);
     SET_FUNCTION_TPL("setSteamNetworkingSendRates", SetSteamNetworkingSendRates);
+    SET_FUNCTION_TPL("setConfigValue", SetConfigValue);
+    SET_FUNCTION_TPL("getConfigValue", GetConfigValue);
     SET_FUNCTION_TPL("setSteamNetworkingDebugCallback", SetSteamNetworkingDebugCallback);
 
     // old
@@ -1836,11 +3977,26 @@ void InitNetworkingObject(Napi::Env env, Napi::Object exports)
     SET_FUNCTION_TPL("setP2PSessionRequestCallback", SetP2PSessionRequestCallback);
     SET_FUNCTION_TPL("setP2PSessionConnectFailCallback", SetP2PSessionConnectFailCallback);
 
+    // in-process
+    SET_FUNCTION_TPL("enableLoopback", EnableLoopback);
+    SET_FUNCTION_TPL("disableLoopback", DisableLoopback);
+    SET_FUNCTION_TPL("createLoopbackPeer", CreateLoopbackPeer);
+    SET_FUNCTION_TPL("setLoopbackActivePeer", SetLoopbackActivePeer);
+    SET_FUNCTION_TPL("setLoopbackLinkConfig", SetLoopbackLinkConfig);
+    SET_FUNCTION_TPL("getLoopbackStats", GetLoopbackStats);
+    SET_FUNCTION_TPL("startCapture", StartCapture);
+    SET_FUNCTION_TPL("stopCapture", StopCapture);
+    SET_FUNCTION_TPL("startReplay", StartReplay);
+    SET_FUNCTION_TPL("stopReplay", StopReplay);
+    SET_FUNCTION_TPL("getReplayStatus", GetReplayStatus);
+
     exports.Set("networking", tpl);
 }
 
 Napi::Object InitAll(Napi::Env env, Napi::Object exports)
 {
+    SetNetworkingActivityObserver(OnNetworkingActivity);
+
     // Common APIs.
     SET_FUNCTION("initialize", Initialize);
     SET_FUNCTION("shutdown", Shutdown);
@@ -1851,8 +4007,18 @@ Napi::Object InitAll(Napi::Env env, Napi::Object exports)
     // File APIs.
     SET_FUNCTION("getFileCount", GetFileCount);
     SET_FUNCTION("getFileNameAndSize", GetFileNameAndSize);
+    SET_FUNCTION("listCloudFiles", ListCloudFiles);
     SET_FUNCTION("deleteRemoteFile", DeleteRemoteFile);
+    SET_FUNCTION("deleteRemoteFiles", DeleteRemoteFiles);
     SET_FUNCTION("saveFilesToCloud", SaveFilesToCloud);
+    SET_FUNCTION("syncFilesToCloud", SyncFilesToCloud);
+    SET_FUNCTION("readFile", ReadFile);
+    SET_FUNCTION("readFileSlice", ReadFileSlice);
+    SET_FUNCTION("writeFile", WriteFile);
+    SET_FUNCTION("commitCloudWriteBatch", CommitCloudWriteBatch);
+    SET_FUNCTION("setCloudCompression", SetCloudCompression);
+    SET_FUNCTION("setCloudCacheBudget", SetCloudCacheBudget);
+    SET_FUNCTION("getCloudCacheStats", GetCloudCacheStats);
 
     // Cloud APIs.
     SET_FUNCTION("isCloudEnabled", IsCloudEnabled);
@@ -1919,6 +4085,8 @@ Napi::Object InitAll(Napi::Env env, Napi::Object exports)
     SET_FUNCTION("setLobbyData", SetLobbyData);
     SET_FUNCTION("getLobbyOwner", GetLobbyOwner);
     SET_FUNCTION("getLobbyMembers", GetLobbyMembers);
+    SET_FUNCTION("getLobbyMemberData", GetLobbyMemberData);
+    SET_FUNCTION("setLobbyMemberData", SetLobbyMemberData);
     SET_FUNCTION("onLobbyCreated", OnLobbyCreated);
     SET_FUNCTION("onLobbyEntered", OnLobbyEntered);
     SET_FUNCTION("onLobbyChatUpdate", OnLobbyChatUpdate);
@@ -9,86 +9,583 @@
 #include "uv.h"
 #include "v8.h"
 
+#include "greenworks_cloud_cache.h"
+#include "greenworks_cloud_sync.h"
 #include "greenworks_unzip.h"
 #include "greenworks_utils.h"
 #include "greenworks_zip.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+
+// Wraps |*data| in a Buffer that frees it once collected, taking ownership. Runtimes with the V8
+// sandbox enabled refuse external buffers; there the data is copied and left with the caller.
+Napi::Buffer<char> TakeBuffer(Napi::Env env, char **data, size_t size)
+{
+    Napi::Buffer<char> buffer = Napi::Buffer<char>::New(env, *data, size, [](Napi::Env, char *data) { delete[] data; });
+    if (!env.IsExceptionPending())
+    {
+        *data = nullptr;
+        return buffer;
+    }
+
+    env.GetAndClearPendingException();
+    return Napi::Buffer<char>::Copy(env, *data, size);
+}
+
+// A fixed set of chunk buffers passed between a disk reader and a Steam writer. With two buffers the
+// next chunk is read while the current one is written.
+class ChunkPipeline
+{
+  public:
+    struct Chunk
+    {
+        size_t file_index;
+        uint64 file_size;
+        std::vector<char> data;
+        size_t size;
+        bool first;
+        bool last;
+        bool open_failed;
+    };
+
+    ChunkPipeline(size_t chunk_size, size_t depth) : chunks_(depth), cancelled_(false), finished_(false)
+    {
+        for (Chunk &chunk : chunks_)
+        {
+            chunk.data.resize(chunk_size);
+            empty_.push_back(&chunk);
+        }
+    }
+
+    // Reader side. Returns nullptr once the writer has cancelled.
+    Chunk *AcquireEmpty()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [this] { return cancelled_ || !empty_.empty(); });
+        if (cancelled_)
+            return nullptr;
+        Chunk *chunk = empty_.front();
+        empty_.pop_front();
+        return chunk;
+    }
+
+    void PushFull(Chunk *chunk)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        full_.push_back(chunk);
+        changed_.notify_all();
+    }
+
+    void Finish()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_ = true;
+        changed_.notify_all();
+    }
+
+    // Writer side. Returns nullptr after the last chunk.
+    Chunk *PopFull()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [this] { return finished_ || !full_.empty(); });
+        if (full_.empty())
+            return nullptr;
+        Chunk *chunk = full_.front();
+        full_.pop_front();
+        return chunk;
+    }
+
+    void ReleaseEmpty(Chunk *chunk)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        empty_.push_back(chunk);
+        changed_.notify_all();
+    }
+
+    void Cancel()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancelled_ = true;
+        changed_.notify_all();
+    }
+
+  private:
+    std::vector<Chunk> chunks_;
+    std::deque<Chunk *> empty_;
+    std::deque<Chunk *> full_;
+    bool cancelled_;
+    bool finished_;
+    std::mutex mutex_;
+    std::condition_variable changed_;
+};
+
+void ReadFilesIntoPipeline(const std::vector<std::string> &files_path, ChunkPipeline *pipeline)
+{
+    for (size_t i = 0; i < files_path.size(); ++i)
+    {
+        std::ifstream fileStream(files_path[i], std::ios::in | std::ios::binary | std::ios::ate);
+
+        ChunkPipeline::Chunk *chunk = pipeline->AcquireEmpty();
+        if (chunk == nullptr)
+            break;
+        chunk->file_index = i;
+        chunk->open_failed = !fileStream.is_open();
+        if (chunk->open_failed)
+        {
+            pipeline->PushFull(chunk);
+            break;
+        }
+
+        chunk->file_size = static_cast<uint64>(fileStream.tellg());
+        fileStream.seekg(0);
+
+        uint64 remaining = chunk->file_size;
+        bool first = true;
+        for (;;)
+        {
+            fileStream.read(chunk->data.data(), static_cast<std::streamsize>(chunk->data.size()));
+            chunk->size = static_cast<size_t>(fileStream.gcount());
+            remaining -= std::min<uint64>(remaining, chunk->size);
+            chunk->first = first;
+            chunk->last = remaining == 0 || chunk->size < chunk->data.size();
+            first = false;
+
+            bool last = chunk->last;
+            uint64 file_size = chunk->file_size;
+            pipeline->PushFull(chunk);
+            if (last)
+                break;
+
+            chunk = pipeline->AcquireEmpty();
+            if (chunk == nullptr)
+                return;
+            chunk->file_index = i;
+            chunk->file_size = file_size;
+            chunk->open_failed = false;
+        }
+    }
+    pipeline->Finish();
+}
+
+} // namespace
 
 FileContentSaveWorker::FileContentSaveWorker(Napi::Function &callback, std::string file_name, std::string content)
-    : SteamAsyncWorker(callback), file_name_(file_name), content_(content)
+    : SteamAsyncWorker(callback), file_name_(file_name), content_(content),
+      compression_(cloud_compression::GetSettings())
 {
 }
 
 void FileContentSaveWorker::Execute()
 {
+    if (compression_.enabled)
+    {
+        std::string compressed;
+        if (!cloud_compression::Compress(compression_.level, content_.data(), content_.size(), &compressed))
+        {
+            SetError("Error on compressing file.");
+            return;
+        }
+        content_.swap(compressed);
+    }
+
     if (!SteamRemoteStorage()->FileWrite(file_name_.c_str(), content_.c_str(), static_cast<int32>(content_.size())))
         SetError("Error on writing to file.");
+    GetCloudFileCache()->Invalidate(file_name_);
+}
+
+CloudWriteBatchWorker::CloudWriteBatchWorker(Napi::Function &callback, std::vector<Operation> &operations)
+    : SteamAsyncWorker(callback), compression_(cloud_compression::GetSettings())
+{
+    operations_.swap(operations);
+}
+
+void CloudWriteBatchWorker::Execute()
+{
+    ISteamRemoteStorage *steam_remote_storage = SteamRemoteStorage();
+
+    if (!steam_remote_storage->BeginFileWriteBatch())
+    {
+        SetError("Error on beginning the write batch.");
+        return;
+    }
+
+    for (Operation &operation : operations_)
+    {
+        if (operation.remove)
+        {
+            if (!steam_remote_storage->FileDelete(operation.file_name.c_str()))
+            {
+                SetErrorEx("Error on deleting file %s.", operation.file_name.c_str());
+                break;
+            }
+            continue;
+        }
+
+        if (compression_.enabled)
+        {
+            std::string compressed;
+            if (!cloud_compression::Compress(compression_.level, operation.content.data(), operation.content.size(),
+                                             &compressed))
+            {
+                SetErrorEx("Error on compressing file %s.", operation.file_name.c_str());
+                break;
+            }
+            operation.content.swap(compressed);
+        }
+
+        if (!steam_remote_storage->FileWrite(operation.file_name.c_str(), operation.content.data(),
+                                             static_cast<int32>(operation.content.size())))
+        {
+            SetErrorEx("Error on writing file %s.", operation.file_name.c_str());
+            break;
+        }
+    }
+
+    if (!steam_remote_storage->EndFileWriteBatch())
+        SetError("Error on ending the write batch.");
+
+    for (const Operation &operation : operations_)
+        GetCloudFileCache()->Invalidate(operation.file_name);
+}
+
+CloudFilesDeleteWorker::CloudFilesDeleteWorker(Napi::Function &callback, const std::vector<std::string> &file_names,
+                                               bool forget)
+    : SteamAsyncWorker(callback), file_names_(file_names), forget_(forget)
+{
+}
+
+void CloudFilesDeleteWorker::Execute()
+{
+    ISteamRemoteStorage *steam_remote_storage = SteamRemoteStorage();
+
+    bool batched = steam_remote_storage->BeginFileWriteBatch();
+    results_.resize(file_names_.size());
+    for (size_t i = 0; i < file_names_.size(); ++i)
+    {
+        const char *file_name = file_names_[i].c_str();
+        bool succeeded = forget_ ? steam_remote_storage->FileForget(file_name)
+                                 : steam_remote_storage->FileDelete(file_name);
+        results_[i] = succeeded ? 1 : 0;
+        // A forgotten file keeps its content, so the cache stays valid.
+        if (!forget_)
+            GetCloudFileCache()->Invalidate(file_names_[i]);
+    }
+    if (batched)
+        steam_remote_storage->EndFileWriteBatch();
+}
+
+void CloudFilesDeleteWorker::OnOK()
+{
+    Napi::Env env = Env();
+
+    uint32 succeeded = 0;
+    Napi::Uint8Array results = Napi::Uint8Array::New(env, results_.size());
+    for (size_t i = 0; i < results_.size(); ++i)
+    {
+        results[i] = results_[i];
+        succeeded += results_[i];
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("succeeded", Napi::Number::New(env, succeeded));
+    result.Set("results", results);
+    Callback().Call({env.Null(), result});
 }
 
 FilesSaveWorker::FilesSaveWorker(Napi::Function &callback, const std::vector<std::string> &files_path)
-    : SteamAsyncWorker(callback), files_path_(files_path)
+    : SteamAsyncWorker(callback), files_path_(files_path), compression_(cloud_compression::GetSettings()),
+      has_progress_(false), pending_progress_(0)
+{
+}
+
+FilesSaveWorker::FilesSaveWorker(Napi::Function &callback, const std::vector<std::string> &files_path,
+                                 Napi::Function &progress)
+    : SteamAsyncWorker(callback), files_path_(files_path), compression_(cloud_compression::GetSettings()),
+      has_progress_(true), pending_progress_(0)
+{
+    progress_ = Napi::ThreadSafeFunction::New(callback.Env(), progress, "FilesSaveProgress", 0, 1);
+}
+
+FilesSaveWorker::~FilesSaveWorker()
 {
+    if (has_progress_)
+        progress_.Release();
 }
 
 void FilesSaveWorker::Execute()
 {
-    char *pBuffer = new char[FILE_BUFFER_SIZE];
+    Upload();
+}
 
-    for (size_t i = 0; i < files_path_.size(); ++i)
-    {
-        auto filePath = files_path_[i];
+bool FilesSaveWorker::Upload()
+{
+    bool succeeded = false;
+    ChunkPipeline pipeline(FILE_BUFFER_SIZE, 2);
+    std::thread reader(ReadFilesIntoPipeline, std::cref(files_path_), &pipeline);
+
+    UGCFileWriteStreamHandle_t remoteFileHandle = k_UGCFileStreamHandleInvalid;
+    uint64 bytesWritten = 0;
 
-        std::ifstream fileStream(filePath, std::ios::in | std::ios::binary);
-        if (!fileStream.is_open())
+    std::unique_ptr<cloud_compression::Deflater> deflater;
+    if (compression_.enabled)
+        deflater.reset(new cloud_compression::Deflater(compression_.level));
+    cloud_compression::Deflater::Sink writeCompressed = [&remoteFileHandle](const char *data, size_t size) {
+        return SteamRemoteStorage()->FileWriteStreamWriteChunk(remoteFileHandle, data, static_cast<int32>(size));
+    };
+
+    while (ChunkPipeline::Chunk *chunk = pipeline.PopFull())
+    {
+        if (chunk->open_failed)
         {
             SetError("Failed to open file (1)");
             break;
         }
 
-        std::string file_name = utils::GetFileNameFromPath(files_path_[i]);
+        if (chunk->first)
+        {
+            std::string file_name = utils::GetFileNameFromPath(files_path_[chunk->file_index]);
+            remoteFileHandle = SteamRemoteStorage()->FileWriteStreamOpen(file_name.c_str());
+            if (remoteFileHandle == k_UGCFileStreamHandleInvalid)
+            {
+                SetError("Failed to open file write stream");
+                break;
+            }
+            bytesWritten = 0;
+
+            if (deflater && !deflater->Begin(chunk->file_size, writeCompressed))
+            {
+                SteamRemoteStorage()->FileWriteStreamCancel(remoteFileHandle);
+                SetError("Failed to write chunk to file stream");
+                break;
+            }
+        }
 
-        auto remoteFileHandle = SteamRemoteStorage()->FileWriteStreamOpen(file_name.c_str());
-        if (remoteFileHandle == k_UGCFileStreamHandleInvalid)
+        // The compressed header promised |file_size| bytes; a file that shrank while it was read would
+        // be stored as a stream that can never be inflated.
+        if (deflater && chunk->last && bytesWritten + chunk->size != chunk->file_size)
         {
-            SetError("Failed to open file write stream");
+            SteamRemoteStorage()->FileWriteStreamCancel(remoteFileHandle);
+            SetErrorEx("File %s changed while it was uploaded", files_path_[chunk->file_index].c_str());
             break;
         }
 
-        bool wroteChunk = true;
+        bool written = deflater ? deflater->Write(chunk->data.data(), chunk->size, chunk->last, writeCompressed)
+                                : chunk->size == 0 || writeCompressed(chunk->data.data(), chunk->size);
+        if (!written)
+        {
+            SteamRemoteStorage()->FileWriteStreamCancel(remoteFileHandle);
+            SetError("Failed to write chunk to file stream");
+            break;
+        }
+        bytesWritten += chunk->size;
 
-        while (wroteChunk && !fileStream.eof())
+        if (chunk->last)
         {
-            fileStream.read(pBuffer, FILE_BUFFER_SIZE);
+            UGCFileWriteStreamHandle_t closingHandle = remoteFileHandle;
+            remoteFileHandle = k_UGCFileStreamHandleInvalid;
+            if (!SteamRemoteStorage()->FileWriteStreamClose(closingHandle))
+            {
+                SetError("Failed to close file stream");
+                break;
+            }
+        }
+
+        ReportProgress(chunk->file_index, bytesWritten, chunk->file_size);
+        succeeded = chunk->last && chunk->file_index + 1 == files_path_.size();
+        pipeline.ReleaseEmpty(chunk);
+    }
+
+    pipeline.Cancel();
+    reader.join();
+    // The done callback must not overtake the last progress calls still queued for the JS thread.
+    WaitForProgress();
+
+    for (const std::string &path : files_path_)
+        GetCloudFileCache()->Invalidate(utils::GetFileNameFromPath(path));
+    return succeeded || files_path_.empty();
+}
+
+FilesSyncWorker::FilesSyncWorker(Napi::Function &callback, const std::vector<std::string> &files_path)
+    : FilesSaveWorker(callback, files_path)
+{
+}
+
+FilesSyncWorker::FilesSyncWorker(Napi::Function &callback, const std::vector<std::string> &files_path,
+                                 Napi::Function &progress)
+    : FilesSaveWorker(callback, files_path, progress)
+{
+}
+
+void FilesSyncWorker::Execute()
+{
+    ISteamRemoteStorage *steam_remote_storage = SteamRemoteStorage();
+
+    CloudManifest manifest;
+    if (steam_remote_storage->FileExists(kCloudManifestFileName))
+    {
+        int32 manifest_size = steam_remote_storage->GetFileSize(kCloudManifestFileName);
+        std::string content(manifest_size > 0 ? manifest_size : 0, '\0');
+        if (manifest_size > 0)
+            content.resize(steam_remote_storage->FileRead(kCloudManifestFileName, &content[0], manifest_size));
+        cloud_sync::ParseManifest(content, &manifest);
+    }
 
-            std::streamsize readLength = fileStream.gcount();
+    std::vector<CloudManifestEntry> entries;
+    std::vector<uint8> readable;
+    cloud_sync::HashFiles(files_path_, &entries, &readable);
 
-            wroteChunk = SteamRemoteStorage()->FileWriteStreamWriteChunk(remoteFileHandle, pBuffer, readLength);
+    std::vector<std::string> changed_paths;
+    std::vector<std::pair<std::string, CloudManifestEntry>> changed_entries;
+    for (size_t i = 0; i < files_path_.size(); ++i)
+    {
+        if (!readable[i])
+        {
+            SetErrorEx("Failed to read file %s", files_path_[i].c_str());
+            return;
         }
 
-        if (!wroteChunk)
+        std::string file_name = utils::GetFileNameFromPath(files_path_[i]);
+        auto recorded = manifest.find(file_name);
+        // The manifest only knows what this sync wrote; the cloud copy must still be there and
+        // have the recorded size. Compressed copies have no size to compare against.
+        if (recorded != manifest.end() && recorded->second.crc == entries[i].crc &&
+            recorded->second.size == entries[i].size && steam_remote_storage->FileExists(file_name.c_str()) &&
+            (compression_.enabled ||
+             static_cast<uint64>(steam_remote_storage->GetFileSize(file_name.c_str())) == entries[i].size))
         {
-            SetError("Failed to write chunk to file stream");
-            break;
+            skipped_.push_back(file_name);
+            continue;
         }
 
-        if (!SteamRemoteStorage()->FileWriteStreamClose(remoteFileHandle))
+        changed_paths.push_back(files_path_[i]);
+        changed_entries.push_back(std::make_pair(file_name, entries[i]));
+    }
+
+    files_path_.swap(changed_paths);
+    if (!Upload())
+        return;
+
+    for (const auto &entry : changed_entries)
+    {
+        manifest[entry.first] = entry.second;
+        uploaded_.push_back(entry.first);
+    }
+
+    if (!uploaded_.empty())
+    {
+        std::string content = cloud_sync::SerializeManifest(manifest);
+        if (!steam_remote_storage->FileWrite(kCloudManifestFileName, content.data(),
+                                             static_cast<int32>(content.size())))
+            SetError("Failed to write the cloud manifest");
+        GetCloudFileCache()->Invalidate(kCloudManifestFileName);
+    }
+}
+
+void FilesSyncWorker::OnOK()
+{
+    Napi::Env env = Env();
+
+    Napi::Array uploaded = Napi::Array::New(env, uploaded_.size());
+    for (size_t i = 0; i < uploaded_.size(); ++i)
+        uploaded.Set(i, Napi::String::New(env, uploaded_[i]));
+
+    Napi::Array skipped = Napi::Array::New(env, skipped_.size());
+    for (size_t i = 0; i < skipped_.size(); ++i)
+        skipped.Set(i, Napi::String::New(env, skipped_[i]));
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("uploaded", uploaded);
+    result.Set("skipped", skipped);
+    Callback().Call({env.Null(), result});
+}
+
+void FilesSaveWorker::ReportProgress(size_t file_index, uint64 bytes_written, uint64 file_size)
+{
+    if (!has_progress_)
+        return;
+
+    struct Progress
+    {
+        FilesSaveWorker *worker;
+        std::string path;
+        uint64 bytes_written;
+        uint64 file_size;
+        size_t file_index;
+    };
+
+    Progress *progress = new Progress{this, files_path_[file_index], bytes_written, file_size, file_index};
+    auto callback = [](Napi::Env env, Napi::Function jsCallback, Progress *data) {
+        // |env| is null when the queue is flushed during teardown.
+        if (static_cast<napi_env>(env) != nullptr)
         {
-            SetError("Failed to close file stream");
-            break;
+            jsCallback.Call({Napi::String::New(env, data->path),
+                             Napi::Number::New(env, static_cast<double>(data->bytes_written)),
+                             Napi::Number::New(env, static_cast<double>(data->file_size)),
+                             Napi::Number::New(env, static_cast<double>(data->file_index))});
         }
+        data->worker->ProgressDelivered();
+        delete data;
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(progress_mutex_);
+        ++pending_progress_;
+    }
+    napi_status status = progress_.NonBlockingCall(progress, callback);
+    if (status != napi_ok)
+    {
+        delete progress;
+        ProgressDelivered();
     }
+}
+
+void FilesSaveWorker::ProgressDelivered()
+{
+    std::lock_guard<std::mutex> lock(progress_mutex_);
+    --pending_progress_;
+    progress_drained_.notify_all();
+}
+
+void FilesSaveWorker::WaitForProgress()
+{
+    std::unique_lock<std::mutex> lock(progress_mutex_);
+    progress_drained_.wait(lock, [this] { return pending_progress_ == 0; });
+}
 
-    delete[] pBuffer;
+FileReadWorker::FileReadWorker(Napi::Function &callback, std::string file_name, std::string encoding)
+    : SteamAsyncWorker(callback), file_name_(file_name), encoding_(encoding), content_(nullptr), content_size_(0)
+{
 }
 
-FileReadWorker::FileReadWorker(Napi::Function &callback, std::string file_name)
-    : SteamAsyncWorker(callback), file_name_(file_name)
+FileReadWorker::~FileReadWorker()
 {
+    delete[] content_;
 }
 
 void FileReadWorker::Execute()
 {
+    CloudFileCache *cache = GetCloudFileCache();
+    std::vector<char> cached;
+    if (cache->Get(file_name_, &cached))
+    {
+        content_size_ = static_cast<int32>(cached.size());
+        content_ = new char[cached.empty() ? 1 : cached.size()];
+        memcpy(content_, cached.data(), cached.size());
+        return;
+    }
+    uint64 generation = cache->GetGeneration();
+
     ISteamRemoteStorage *steam_remote_storage = SteamRemoteStorage();
 
     if (!steam_remote_storage->FileExists(file_name_.c_str()))
@@ -99,25 +596,202 @@ void FileReadWorker::Execute()
 
     int32 file_size = steam_remote_storage->GetFileSize(file_name_.c_str());
 
-    char *content = new char[file_size + 1];
-    int32 end_pos = steam_remote_storage->FileRead(file_name_.c_str(), content, file_size);
-    content[end_pos] = '\0';
+    // At least one byte so an empty file still gets a buffer to hand out.
+    content_ = new char[file_size > 0 ? file_size : 1];
+    content_size_ = steam_remote_storage->FileRead(file_name_.c_str(), content_, file_size);
 
-    if (end_pos == 0 && file_size > 0)
+    if (content_size_ == 0 && file_size > 0)
     {
         SetError("Error on reading file.");
+        return;
     }
-    else
+
+    uint64 original_size;
+    if (cloud_compression::ReadHeader(content_, content_size_, &original_size))
     {
-        content_ = std::string(content);
+        // The size comes from the file itself; bound it before it picks the allocation.
+        uint64 compressed_size = static_cast<uint64>(content_size_) - cloud_compression::kHeaderSize;
+        if (original_size > k_unMaxCloudFileChunkSize ||
+            original_size > compressed_size * cloud_compression::kMaxDeflateRatio)
+        {
+            SetError("Error on inflating file.");
+            return;
+        }
+        char *inflated = new char[original_size > 0 ? original_size : 1];
+        if (!cloud_compression::Inflate(content_ + cloud_compression::kHeaderSize,
+                                        content_size_ - cloud_compression::kHeaderSize, inflated, original_size))
+        {
+            delete[] inflated;
+            SetError("Error on inflating file.");
+            return;
+        }
+        delete[] content_;
+        content_ = inflated;
+        content_size_ = static_cast<int32>(original_size);
     }
 
-    delete[] content;
+    cache->Put(file_name_, content_, content_size_, generation);
 }
 
 void FileReadWorker::OnOK()
 {
-    Callback().Call({Env().Null(), Napi::String::New(Env(), content_)});
+    Napi::Env env = Env();
+
+    Napi::Buffer<char> buffer = TakeBuffer(env, &content_, content_size_);
+
+    if (encoding_.empty())
+    {
+        Callback().Call({env.Null(), buffer});
+        return;
+    }
+
+    // Buffer#toString knows every encoding Node does.
+    Napi::Value text = buffer.Get("toString").As<Napi::Function>().Call(buffer, {Napi::String::New(env, encoding_)});
+    if (env.IsExceptionPending())
+    {
+        Callback().Call({env.GetAndClearPendingException().Value()});
+        return;
+    }
+
+    Callback().Call({env.Null(), text});
+}
+
+FileReadSliceWorker::FileReadSliceWorker(Napi::Function &callback, std::string file_name, uint32 offset,
+                                         uint32 length)
+    : SteamCallbackAsyncWorker(callback), file_name_(file_name), offset_(offset), length_(length), file_size_(0),
+      content_(nullptr), content_size_(0)
+{
+}
+
+FileReadSliceWorker::~FileReadSliceWorker()
+{
+    delete[] content_;
+}
+
+void FileReadSliceWorker::Execute()
+{
+    ISteamRemoteStorage *steam_remote_storage = SteamRemoteStorage();
+
+    if (!steam_remote_storage->FileExists(file_name_.c_str()))
+    {
+        SetError("File doesn't exist.");
+        return;
+    }
+
+    file_size_ = steam_remote_storage->GetFileSize(file_name_.c_str());
+    if (offset_ > static_cast<uint32>(file_size_))
+    {
+        SetError("Offset is past the end of the file.");
+        return;
+    }
+
+    uint32 to_read = std::min(length_, static_cast<uint32>(file_size_) - offset_);
+    if (to_read == 0)
+    {
+        content_ = new char[1];
+        return;
+    }
+
+    SteamAPICall_t read_call = steam_remote_storage->FileReadAsync(file_name_.c_str(), offset_, to_read);
+    if (read_call == k_uAPICallInvalid)
+    {
+        SetError("Error on reading file.");
+        return;
+    }
+    call_result_.Set(read_call, this, &FileReadSliceWorker::OnFileReadAsyncCompleted);
+
+    WaitForCompleted();
+}
+
+void FileReadSliceWorker::OnFileReadAsyncCompleted(RemoteStorageFileReadAsyncComplete_t *result, bool io_failure)
+{
+    if (io_failure)
+    {
+        SetError("Error on reading file: Steam API IO Failure");
+    }
+    else if (result->m_eResult != k_EResultOK)
+    {
+        SetErrorEx("Error on reading file: %d", result->m_eResult);
+    }
+    else
+    {
+        // The data has to be collected from inside the call result.
+        content_ = new char[result->m_cubRead > 0 ? result->m_cubRead : 1];
+        if (SteamRemoteStorage()->FileReadAsyncComplete(result->m_hFileReadAsync, content_, result->m_cubRead))
+            content_size_ = result->m_cubRead;
+        else
+            SetError("Error on reading file.");
+    }
+    is_completed_ = true;
+}
+
+void FileReadSliceWorker::OnOK()
+{
+    Napi::Env env = Env();
+    Napi::Buffer<char> buffer = TakeBuffer(env, &content_, content_size_);
+    Callback().Call({env.Null(), buffer, Napi::Number::New(env, file_size_)});
+}
+
+CloudFilesListWorker::CloudFilesListWorker(Napi::Function &callback) : SteamAsyncWorker(callback)
+{
+}
+
+void CloudFilesListWorker::Execute()
+{
+    ISteamRemoteStorage *steam_remote_storage = SteamRemoteStorage();
+
+    int32 count = steam_remote_storage->GetFileCount();
+    for (int32 i = 0; i < count; ++i)
+    {
+        int32 size = 0;
+        const char *name = steam_remote_storage->GetFileNameAndSize(i, &size);
+        // The list can shrink while it is walked.
+        if (name == nullptr || name[0] == '\0')
+            continue;
+
+        names_.push_back(name);
+        sizes_.push_back(size);
+        timestamps_.push_back(steam_remote_storage->GetFileTimestamp(name));
+        persisted_.push_back(steam_remote_storage->FilePersisted(name) ? 1 : 0);
+        sync_platforms_.push_back(static_cast<uint32>(steam_remote_storage->GetSyncPlatforms(name)));
+    }
+}
+
+void CloudFilesListWorker::OnOK()
+{
+    Napi::Env env = Env();
+    size_t count = names_.size();
+
+    // One allocation for every numeric column, the 8 byte one first to keep the views aligned.
+    size_t timestampsOffset = 0;
+    size_t sizesOffset = timestampsOffset + count * sizeof(double);
+    size_t syncPlatformsOffset = sizesOffset + count * sizeof(int32);
+    size_t persistedOffset = syncPlatformsOffset + count * sizeof(uint32);
+
+    Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, persistedOffset + count);
+    Napi::Float64Array timestamps = Napi::Float64Array::New(env, count, buffer, timestampsOffset);
+    Napi::Int32Array sizes = Napi::Int32Array::New(env, count, buffer, sizesOffset);
+    Napi::Uint32Array syncPlatforms = Napi::Uint32Array::New(env, count, buffer, syncPlatformsOffset);
+    Napi::Uint8Array persisted = Napi::Uint8Array::New(env, count, buffer, persistedOffset);
+
+    Napi::Array names = Napi::Array::New(env, count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        names.Set(i, Napi::String::New(env, names_[i]));
+        timestamps[i] = static_cast<double>(timestamps_[i]);
+        sizes[i] = sizes_[i];
+        syncPlatforms[i] = sync_platforms_[i];
+        persisted[i] = persisted_[i];
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("count", Napi::Number::New(env, static_cast<double>(count)));
+    result.Set("names", names);
+    result.Set("sizes", sizes);
+    result.Set("timestamps", timestamps);
+    result.Set("persisted", persisted);
+    result.Set("syncPlatforms", syncPlatforms);
+    Callback().Call({env.Null(), result});
 }
 
 CloudQuotaGetWorker::CloudQuotaGetWorker(Napi::Function &callback)
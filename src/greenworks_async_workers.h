@@ -5,13 +5,17 @@
 #ifndef SRC_GREENWORK_ASYNC_WORKERS_H_
 #define SRC_GREENWORK_ASYNC_WORKERS_H_
 
+#include <condition_variable>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include "steam/steam_api.h"
 
+#include "greenworks_cloud_compression.h"
 #include "steam_async_worker.h"
 
+// Writes |content| with FileWrite, deflated first when cloud compression is on.
 class FileContentSaveWorker : public SteamAsyncWorker
 {
   public:
@@ -23,24 +27,108 @@ class FileContentSaveWorker : public SteamAsyncWorker
   private:
     std::string file_name_;
     std::string content_;
+    cloud_compression::Settings compression_;
 };
 
+// Uploads local files to Steam Cloud. A reader thread fills one buffer from disk while the worker
+// writes the other to the cloud write stream. After every chunk |progress|, when given, is called
+// with (path, bytesWritten, fileSize, fileIndex) through a threadsafe function; all progress calls
+// have run before the done callback. With cloud compression on, every chunk goes through a deflate
+// stream on its way to the cloud.
 class FilesSaveWorker : public SteamAsyncWorker
 {
   public:
     FilesSaveWorker(Napi::Function &callback, const std::vector<std::string> &files_path);
+    FilesSaveWorker(Napi::Function &callback, const std::vector<std::string> &files_path, Napi::Function &progress);
+    ~FilesSaveWorker();
 
     // Override NanAsyncWorker methods.
     virtual void Execute() override;
 
-  private:
+  protected:
+    // Uploads |files_path_|, stopping at the first failure. Returns false once an error is set.
+    bool Upload();
+
     std::vector<std::string> files_path_;
+    cloud_compression::Settings compression_;
+
+  private:
+    void ReportProgress(size_t file_index, uint64 bytes_written, uint64 file_size);
+    void ProgressDelivered();
+    void WaitForProgress();
+
+    bool has_progress_;
+    Napi::ThreadSafeFunction progress_;
+    std::mutex progress_mutex_;
+    std::condition_variable progress_drained_;
+    size_t pending_progress_;
+};
+
+// Uploads only the files whose size or CRC-32 differs from what the cloud manifest recorded at the
+// last sync, or which are missing from the cloud, then updates the manifest. Calls back with the
+// names that were uploaded and the ones that were skipped.
+class FilesSyncWorker : public FilesSaveWorker
+{
+  public:
+    FilesSyncWorker(Napi::Function &callback, const std::vector<std::string> &files_path);
+    FilesSyncWorker(Napi::Function &callback, const std::vector<std::string> &files_path, Napi::Function &progress);
+
+    // Override NanAsyncWorker methods.
+    virtual void Execute() override;
+    virtual void OnOK() override;
+
+  private:
+    std::vector<std::string> uploaded_;
+    std::vector<std::string> skipped_;
+};
+
+// Runs queued writes and deletes inside one BeginFileWriteBatch/EndFileWriteBatch pair, so Steam
+// syncs them as a group. Stops at the first failing operation; the batch is always ended.
+class CloudWriteBatchWorker : public SteamAsyncWorker
+{
+  public:
+    struct Operation
+    {
+        std::string file_name;
+        // Deletes |file_name| instead of writing |content|.
+        bool remove;
+        std::string content;
+    };
+
+    CloudWriteBatchWorker(Napi::Function &callback, std::vector<Operation> &operations);
+
+    // Override NanAsyncWorker methods.
+    virtual void Execute() override;
+
+  private:
+    std::vector<Operation> operations_;
+    cloud_compression::Settings compression_;
+};
+
+// Deletes, or with |forget| only removes from the cloud while keeping the local copies, every file in
+// one worker call and one write batch. Each file gets its own result; failures do not stop the rest.
+class CloudFilesDeleteWorker : public SteamAsyncWorker
+{
+  public:
+    CloudFilesDeleteWorker(Napi::Function &callback, const std::vector<std::string> &file_names, bool forget);
+
+    // Override NanAsyncWorker methods.
+    virtual void Execute() override;
+    virtual void OnOK() override;
+
+  private:
+    std::vector<std::string> file_names_;
+    bool forget_;
+    std::vector<uint8> results_;
 };
 
+// Reads a whole cloud file, inflating it when it was stored compressed. The result is a Buffer over
+// the read buffer itself, or a string when an encoding is given.
 class FileReadWorker : public SteamAsyncWorker
 {
   public:
-    FileReadWorker(Napi::Function &callback, std::string file_name);
+    FileReadWorker(Napi::Function &callback, std::string file_name, std::string encoding);
+    ~FileReadWorker();
 
     // Override NanAsyncWorker methods.
     virtual void Execute() override;
@@ -48,7 +136,52 @@ class FileReadWorker : public SteamAsyncWorker
 
   private:
     std::string file_name_;
-    std::string content_;
+    std::string encoding_;
+    char *content_;
+    int32 content_size_;
+};
+
+// Reads |length| bytes at |offset| of a cloud file with FileReadAsync. The range is clipped to the
+// end of the file; the callback also gets the file size so callers can walk a file chunk by chunk.
+// The bytes are returned as stored, compressed or not.
+class FileReadSliceWorker : public SteamCallbackAsyncWorker
+{
+  public:
+    FileReadSliceWorker(Napi::Function &callback, std::string file_name, uint32 offset, uint32 length);
+    ~FileReadSliceWorker();
+
+    void OnFileReadAsyncCompleted(RemoteStorageFileReadAsyncComplete_t *result, bool io_failure);
+    // Override NanAsyncWorker methods.
+    virtual void Execute() override;
+    virtual void OnOK() override;
+
+  private:
+    std::string file_name_;
+    uint32 offset_;
+    uint32 length_;
+    int32 file_size_;
+    char *content_;
+    uint32 content_size_;
+    CCallResult<FileReadSliceWorker, RemoteStorageFileReadAsyncComplete_t> call_result_;
+};
+
+// Enumerates every cloud file on the worker thread. The callback gets one columnar result: names
+// plus typed arrays of sizes, timestamps, persisted flags and sync platforms, all indexed alike.
+class CloudFilesListWorker : public SteamAsyncWorker
+{
+  public:
+    CloudFilesListWorker(Napi::Function &callback);
+
+    // Override NanAsyncWorker methods.
+    virtual void Execute() override;
+    virtual void OnOK() override;
+
+  private:
+    std::vector<std::string> names_;
+    std::vector<int32> sizes_;
+    std::vector<int64> timestamps_;
+    std::vector<uint8> persisted_;
+    std::vector<uint32> sync_platforms_;
 };
 
 class CloudQuotaGetWorker : public SteamAsyncWorker
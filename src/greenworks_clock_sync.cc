@@ -0,0 +1,168 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "greenworks_clock_sync.h"
+
+#include <cstring>
+
+namespace
+{
+
+enum ClockSyncPacketType
+{
+    kClockSyncRequest = 1,
+    kClockSyncResponse = 2,
+};
+
+// type, then t0 for requests or t0, t1, t2 for responses.
+const uint32 kRequestSize = 9;
+const uint32 kResponseSize = 25;
+
+// Quick requests until the window is full, then a slow trickle to follow drift and route changes.
+const SteamNetworkingMicroseconds kWarmUpInterval = 100 * 1000;
+const SteamNetworkingMicroseconds kSteadyInterval = 1000 * 1000;
+const size_t kWindowSize = 8;
+
+const int kMaxDrainedMessages = 32;
+
+void WriteInt64(uint8 *out, SteamNetworkingMicroseconds value)
+{
+    uint64 bits = static_cast<uint64>(value);
+    for (int i = 0; i < 8; i++)
+        out[i] = static_cast<uint8>(bits >> (8 * i));
+}
+
+SteamNetworkingMicroseconds ReadInt64(const uint8 *in)
+{
+    uint64 bits = 0;
+    for (int i = 0; i < 8; i++)
+        bits |= static_cast<uint64>(in[i]) << (8 * i);
+    return static_cast<SteamNetworkingMicroseconds>(bits);
+}
+
+} // namespace
+
+ClockSync::ClockSync(int channel) : channel_(channel)
+{
+}
+
+void ClockSync::Start(uint64 peer)
+{
+    if (peers_.find(peer) != peers_.end())
+        return;
+
+    PeerState &state = peers_[peer];
+    state.next_request = 0;
+    state.samples = 0;
+}
+
+void ClockSync::Stop(uint64 peer)
+{
+    peers_.erase(peer);
+}
+
+void ClockSync::Tick()
+{
+    NetworkingTransport *transport = GetNetworkingTransport();
+
+    SteamNetworkingMessage_t *messages[kMaxDrainedMessages];
+    int messageCount;
+    while ((messageCount = transport->ReceiveMessagesOnChannel(channel_, messages, kMaxDrainedMessages)) > 0)
+    {
+        for (int i = 0; i < messageCount; i++)
+        {
+            HandleMessage(transport, messages[i]);
+            messages[i]->Release();
+        }
+    }
+
+    if (peers_.empty())
+        return;
+
+    SteamNetworkingMicroseconds now = transport->GetLocalTimestamp();
+    for (auto &peer : peers_)
+    {
+        PeerState &state = peer.second;
+        if (now < state.next_request)
+            continue;
+
+        uint8 request[kRequestSize];
+        request[0] = kClockSyncRequest;
+        WriteInt64(request + 1, transport->GetLocalTimestamp());
+        Send(transport, peer.first, request, sizeof(request));
+
+        state.next_request = now + (state.window.size() < kWindowSize ? kWarmUpInterval : kSteadyInterval);
+    }
+}
+
+void ClockSync::HandleMessage(NetworkingTransport *transport, SteamNetworkingMessage_t *message)
+{
+    const uint8 *data = static_cast<const uint8 *>(message->GetData());
+    uint64 peer = message->m_identityPeer.GetSteamID64();
+
+    if (message->m_cbSize == static_cast<int>(kRequestSize) && data[0] == kClockSyncRequest)
+    {
+        uint8 response[kResponseSize];
+        response[0] = kClockSyncResponse;
+        memcpy(response + 1, data + 1, 8);
+        WriteInt64(response + 9, message->m_usecTimeReceived);
+        // Stamped as late as possible so the time spent waiting for this tick is taken out of the rtt.
+        WriteInt64(response + 17, transport->GetLocalTimestamp());
+        Send(transport, peer, response, sizeof(response));
+        return;
+    }
+
+    if (message->m_cbSize != static_cast<int>(kResponseSize) || data[0] != kClockSyncResponse)
+        return;
+
+    auto found = peers_.find(peer);
+    if (found == peers_.end())
+        return;
+
+    SteamNetworkingMicroseconds t0 = ReadInt64(data + 1);
+    SteamNetworkingMicroseconds t1 = ReadInt64(data + 9);
+    SteamNetworkingMicroseconds t2 = ReadInt64(data + 17);
+    SteamNetworkingMicroseconds t3 = message->m_usecTimeReceived;
+
+    Sample sample;
+    sample.offset = ((t1 - t0) + (t2 - t3)) / 2;
+    sample.rtt = (t3 - t0) - (t2 - t1);
+    if (sample.rtt < 0)
+        return;
+
+    PeerState &state = found->second;
+    state.window.push_back(sample);
+    if (state.window.size() > kWindowSize)
+        state.window.pop_front();
+    ++state.samples;
+}
+
+void ClockSync::Send(NetworkingTransport *transport, uint64 peer, const uint8 *data, uint32 size)
+{
+    SteamNetworkingIdentity identity;
+    identity.SetSteamID64(peer);
+    transport->SendMessageToUser(identity, data, size,
+                                 k_nSteamNetworkingSend_UnreliableNoNagle |
+                                     k_nSteamNetworkingSend_AutoRestartBrokenSession,
+                                 channel_);
+}
+
+bool ClockSync::GetEstimate(uint64 peer, Estimate *estimate) const
+{
+    auto found = peers_.find(peer);
+    if (found == peers_.end() || found->second.window.empty())
+        return false;
+
+    const Sample *best = &found->second.window.front();
+    for (const Sample &sample : found->second.window)
+    {
+        if (sample.rtt < best->rtt)
+            best = &sample;
+    }
+
+    estimate->offset = best->offset;
+    estimate->rtt = best->rtt;
+    estimate->samples = found->second.samples;
+    return true;
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SRC_GREENWORKS_CLOCK_SYNC_H_
+#define SRC_GREENWORKS_CLOCK_SYNC_H_
+
+#include <deque>
+#include <map>
+
+#include "greenworks_networking_transport.h"
+
+// NTP-style estimate of each peer's GetLocalTimestamp() clock relative to ours.
+//
+// A request carries our send time t0. The peer answers with t0, the time it received the request
+// (t1, from m_usecTimeReceived) and the time it sent the answer (t2), and we note the arrival t3:
+//   offset = ((t1 - t0) + (t2 - t3)) / 2      rtt = (t3 - t0) - (t2 - t1)
+// Of the recent samples the one with the smallest rtt wins, as it had the least queuing in it.
+// Every ClockSync answers requests, whether or not it is syncing with the requester itself.
+class ClockSync
+{
+  public:
+    struct Estimate
+    {
+        // Add to a local timestamp to get the peer's clock.
+        SteamNetworkingMicroseconds offset;
+        SteamNetworkingMicroseconds rtt;
+        uint32 samples;
+    };
+
+    explicit ClockSync(int channel);
+
+    void Start(uint64 peer);
+    void Stop(uint64 peer);
+
+    // Answers requests, takes in answers and sends the requests that are due. Called from
+    // RunCallbacks.
+    void Tick();
+
+    // Returns false until a sample has arrived from |peer|.
+    bool GetEstimate(uint64 peer, Estimate *estimate) const;
+
+  private:
+    struct Sample
+    {
+        SteamNetworkingMicroseconds offset;
+        SteamNetworkingMicroseconds rtt;
+    };
+
+    struct PeerState
+    {
+        SteamNetworkingMicroseconds next_request;
+        uint32 samples;
+        std::deque<Sample> window;
+    };
+
+    void HandleMessage(NetworkingTransport *transport, SteamNetworkingMessage_t *message);
+    void Send(NetworkingTransport *transport, uint64 peer, const uint8 *data, uint32 size);
+
+    int channel_;
+    std::map<uint64, PeerState> peers_;
+};
+
+#endif // SRC_GREENWORKS_CLOCK_SYNC_H_
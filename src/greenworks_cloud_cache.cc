@@ -0,0 +1,105 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "greenworks_cloud_cache.h"
+
+#include <cstring>
+
+CloudFileCache::CloudFileCache() : budget_(0), bytes_(0), generation_(0)
+{
+    memset(&stats_, 0, sizeof(stats_));
+}
+
+void CloudFileCache::SetBudget(size_t budget)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_ = budget;
+    Trim();
+}
+
+bool CloudFileCache::Get(const std::string &file_name, std::vector<char> *content)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (budget_ == 0)
+        return false;
+
+    auto entry = index_.find(file_name);
+    if (entry == index_.end())
+    {
+        ++stats_.misses;
+        return false;
+    }
+
+    entries_.splice(entries_.begin(), entries_, entry->second);
+    *content = entry->second->content;
+    ++stats_.hits;
+    return true;
+}
+
+uint64 CloudFileCache::GetGeneration()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return generation_;
+}
+
+void CloudFileCache::Put(const std::string &file_name, const char *data, size_t size, uint64 generation)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (generation != generation_ || size > budget_)
+        return;
+
+    auto entry = index_.find(file_name);
+    if (entry != index_.end())
+        Remove(entry);
+
+    Entry fresh;
+    fresh.file_name = file_name;
+    fresh.content.assign(data, data + size);
+    entries_.push_front(std::move(fresh));
+    index_[file_name] = entries_.begin();
+    bytes_ += size;
+    Trim();
+}
+
+void CloudFileCache::Invalidate(const std::string &file_name)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++generation_;
+
+    auto entry = index_.find(file_name);
+    if (entry != index_.end())
+        Remove(entry);
+}
+
+CloudFileCache::Stats CloudFileCache::GetStats()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.entries = entries_.size();
+    stats.bytes = bytes_;
+    stats.budget = budget_;
+    return stats;
+}
+
+void CloudFileCache::Remove(std::map<std::string, EntryList::iterator>::iterator entry)
+{
+    bytes_ -= entry->second->content.size();
+    entries_.erase(entry->second);
+    index_.erase(entry);
+}
+
+void CloudFileCache::Trim()
+{
+    while (bytes_ > budget_ && !entries_.empty())
+    {
+        Remove(index_.find(entries_.back().file_name));
+        ++stats_.evictions;
+    }
+}
+
+CloudFileCache *GetCloudFileCache()
+{
+    static CloudFileCache cache;
+    return &cache;
+}
@@ -0,0 +1,74 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SRC_GREENWORKS_CLOUD_CACHE_H_
+#define SRC_GREENWORKS_CLOUD_CACHE_H_
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "steam/steamtypes.h"
+
+// Keeps the contents of recently read cloud files, least recently used first out once the byte
+// budget is exceeded. Reads fill it and our own writes and deletes invalidate it. A budget of 0,
+// the default, turns it off. Thread safe.
+class CloudFileCache
+{
+  public:
+    struct Stats
+    {
+        uint64 hits;
+        uint64 misses;
+        uint64 evictions;
+        uint64 entries;
+        uint64 bytes;
+        uint64 budget;
+    };
+
+    CloudFileCache();
+
+    // Shrinking the budget evicts right away.
+    void SetBudget(size_t budget);
+
+    // Copies the cached contents of |file_name| into |content|. Counts a hit or a miss.
+    bool Get(const std::string &file_name, std::vector<char> *content);
+
+    // Invalidations since the cache was created. Read it before reading a file from Steam and pass it
+    // to Put, so a read that raced a write or delete is not cached.
+    uint64 GetGeneration();
+    void Put(const std::string &file_name, const char *data, size_t size, uint64 generation);
+
+    void Invalidate(const std::string &file_name);
+
+    Stats GetStats();
+
+  private:
+    struct Entry
+    {
+        std::string file_name;
+        std::vector<char> content;
+    };
+    typedef std::list<Entry> EntryList;
+
+    void Remove(std::map<std::string, EntryList::iterator>::iterator entry);
+    void Trim();
+
+    std::mutex mutex_;
+    size_t budget_;
+    size_t bytes_;
+    uint64 generation_;
+    // Most recently used at the front.
+    EntryList entries_;
+    std::map<std::string, EntryList::iterator> index_;
+    Stats stats_;
+};
+
+// The cache behind readFile.
+CloudFileCache *GetCloudFileCache();
+
+#endif // SRC_GREENWORKS_CLOUD_CACHE_H_
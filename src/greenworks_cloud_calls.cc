@@ -0,0 +1,49 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "greenworks_cloud_calls.h"
+
+#include "greenworks_cloud_cache.h"
+
+void FileWriteAsyncCall::Start(Napi::Env env, const std::string &file_name, Napi::Object owner, const void *data,
+                               uint32 size, Napi::Function callback)
+{
+    SteamAPICall_t write_call = SteamRemoteStorage()->FileWriteAsync(file_name.c_str(), data, size);
+    if (write_call == k_uAPICallInvalid)
+    {
+        // Bad file name, too large, or over quota.
+        callback.Call({Napi::Error::New(env, "Error on writing file.").Value()});
+        return;
+    }
+
+    FileWriteAsyncCall *call = new FileWriteAsyncCall(env, file_name, owner, callback);
+    call->call_result_.Set(write_call, call, &FileWriteAsyncCall::OnFileWriteAsyncCompleted);
+}
+
+FileWriteAsyncCall::FileWriteAsyncCall(Napi::Env env, const std::string &file_name, Napi::Object owner,
+                                       Napi::Function callback)
+    : env_(env), file_name_(file_name), owner_(Napi::Persistent(owner)), callback_(Napi::Persistent(callback))
+{
+}
+
+void FileWriteAsyncCall::OnFileWriteAsyncCompleted(RemoteStorageFileWriteAsyncComplete_t *result, bool io_failure)
+{
+    GetCloudFileCache()->Invalidate(file_name_);
+
+    if (io_failure)
+    {
+        callback_.Call({Napi::Error::New(env_, "Error on writing file: Steam API IO Failure").Value()});
+    }
+    else if (result->m_eResult != k_EResultOK)
+    {
+        callback_.Call(
+            {Napi::Error::New(env_, "Error on writing file: " + std::to_string(result->m_eResult)).Value()});
+    }
+    else
+    {
+        callback_.Call({env_.Null()});
+    }
+
+    delete this;
+}
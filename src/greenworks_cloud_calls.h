@@ -0,0 +1,36 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SRC_GREENWORKS_CLOUD_CALLS_H_
+#define SRC_GREENWORKS_CLOUD_CALLS_H_
+
+#include <string>
+
+#include "napi.h"
+#include "steam/steam_api.h"
+
+// Steam Cloud requests made on the JS thread and completed through a call result, so no worker
+// thread sits waiting for Steam. Results arrive during runCallbacks; every call deletes itself once
+// it has called back.
+class FileWriteAsyncCall
+{
+  public:
+    // Writes |size| bytes at |data| to |file_name|. |owner| is the JS object holding the bytes and
+    // stays referenced until Steam reports the write done.
+    static void Start(Napi::Env env, const std::string &file_name, Napi::Object owner, const void *data, uint32 size,
+                      Napi::Function callback);
+
+  private:
+    FileWriteAsyncCall(Napi::Env env, const std::string &file_name, Napi::Object owner, Napi::Function callback);
+
+    void OnFileWriteAsyncCompleted(RemoteStorageFileWriteAsyncComplete_t *result, bool io_failure);
+
+    Napi::Env env_;
+    std::string file_name_;
+    Napi::ObjectReference owner_;
+    Napi::FunctionReference callback_;
+    CCallResult<FileWriteAsyncCall, RemoteStorageFileWriteAsyncComplete_t> call_result_;
+};
+
+#endif // SRC_GREENWORKS_CLOUD_CALLS_H_
@@ -0,0 +1,151 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "greenworks_cloud_compression.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+namespace
+{
+
+const char kMagic[4] = {'G', 'W', 'Z', 1};
+
+const size_t kOutBufferSize = 256 * 1024;
+// zlib counts in uInt; larger inputs are fed in pieces.
+const size_t kMaxZlibInput = 1u << 30;
+
+cloud_compression::Settings g_settings = {false, Z_DEFAULT_COMPRESSION};
+
+} // namespace
+
+namespace cloud_compression
+{
+
+void SetSettings(const Settings &settings)
+{
+    g_settings = settings;
+}
+
+Settings GetSettings()
+{
+    return g_settings;
+}
+
+bool ReadHeader(const char *data, size_t size, uint64 *original_size)
+{
+    if (size < kHeaderSize || memcmp(data, kMagic, sizeof(kMagic)) != 0)
+        return false;
+
+    uint64 value = 0;
+    for (int i = 7; i >= 0; --i)
+        value = (value << 8) | static_cast<uint8>(data[sizeof(kMagic) + i]);
+    *original_size = value;
+    return true;
+}
+
+bool Inflate(const char *data, size_t size, char *out, uint64 out_size)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit(&stream) != Z_OK)
+        return false;
+
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    stream.next_out = reinterpret_cast<Bytef *>(out);
+    size_t in_left = size;
+    uint64 out_left = out_size;
+    int result = Z_OK;
+    while (result == Z_OK)
+    {
+        if (stream.avail_in == 0 && in_left > 0)
+        {
+            stream.avail_in = static_cast<uInt>(std::min(in_left, kMaxZlibInput));
+            in_left -= stream.avail_in;
+        }
+        if (stream.avail_out == 0 && out_left > 0)
+        {
+            stream.avail_out = static_cast<uInt>(std::min<uint64>(out_left, kMaxZlibInput));
+            out_left -= stream.avail_out;
+        }
+        result = inflate(&stream, Z_NO_FLUSH);
+        // Out of input or out of room before the end of the stream: the header lied.
+        if (result == Z_BUF_ERROR && (stream.avail_in > 0 || in_left > 0) && (stream.avail_out > 0 || out_left > 0))
+            result = Z_OK;
+    }
+
+    bool complete = result == Z_STREAM_END && stream.total_out == out_size;
+    inflateEnd(&stream);
+    return complete;
+}
+
+Deflater::Deflater(int level) : initialized_(false), out_(kOutBufferSize)
+{
+    memset(&stream_, 0, sizeof(stream_));
+    initialized_ = deflateInit(&stream_, level) == Z_OK;
+}
+
+Deflater::~Deflater()
+{
+    if (initialized_)
+        deflateEnd(&stream_);
+}
+
+bool Deflater::Begin(uint64 original_size, const Sink &sink)
+{
+    if (!initialized_ || deflateReset(&stream_) != Z_OK)
+        return false;
+
+    char header[kHeaderSize];
+    memcpy(header, kMagic, sizeof(kMagic));
+    for (int i = 0; i < 8; ++i)
+        header[sizeof(kMagic) + i] = static_cast<char>((original_size >> (8 * i)) & 0xff);
+    return sink(header, sizeof(header));
+}
+
+bool Deflater::Write(const char *data, size_t size, bool finish, const Sink &sink)
+{
+    for (;;)
+    {
+        size_t piece = std::min(size, kMaxZlibInput);
+        bool last_piece = piece == size;
+        stream_.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+        stream_.avail_in = static_cast<uInt>(piece);
+        int flush = finish && last_piece ? Z_FINISH : Z_NO_FLUSH;
+
+        int result;
+        do
+        {
+            stream_.next_out = reinterpret_cast<Bytef *>(out_.data());
+            stream_.avail_out = static_cast<uInt>(out_.size());
+            result = deflate(&stream_, flush);
+            if (result == Z_STREAM_ERROR)
+                return false;
+            size_t produced = out_.size() - stream_.avail_out;
+            if (produced > 0 && !sink(out_.data(), produced))
+                return false;
+        } while (stream_.avail_out == 0 || (flush == Z_FINISH && result != Z_STREAM_END));
+
+        if (last_piece)
+            return true;
+        data += piece;
+        size -= piece;
+    }
+}
+
+bool Compress(int level, const char *data, size_t size, std::string *out)
+{
+    out->clear();
+    out->reserve(kHeaderSize + deflateBound(nullptr, static_cast<uLong>(std::min(size, kMaxZlibInput))));
+
+    Deflater deflater(level);
+    Deflater::Sink sink = [out](const char *bytes, size_t length) {
+        out->append(bytes, length);
+        return true;
+    };
+    return deflater.Begin(size, sink) && deflater.Write(data, size, true, sink);
+}
+
+} // namespace cloud_compression
@@ -0,0 +1,68 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SRC_GREENWORKS_CLOUD_COMPRESSION_H_
+#define SRC_GREENWORKS_CLOUD_COMPRESSION_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "steam/steam_api.h"
+#include "third_party/zlib/zlib.h"
+
+// Opt-in deflate for Steam Cloud files. A compressed file starts with a 12 byte header, the magic
+// "GWZ\1" and the original size as a little-endian uint64, followed by a zlib stream. Files without
+// the header are read as they are. greenworks.js knows the same layout for cloud read streams.
+namespace cloud_compression
+{
+
+const size_t kHeaderSize = 12;
+
+// Deflate never shrinks data by more than about 1032:1; a header claiming more is corrupt.
+const uint64 kMaxDeflateRatio = 1032;
+
+struct Settings
+{
+    bool enabled;
+    int level;
+};
+
+// Only touched on the JS thread; workers copy the settings when they are created.
+void SetSettings(const Settings &settings);
+Settings GetSettings();
+
+// Returns true when |data| starts with the header, and the original size in |original_size|.
+bool ReadHeader(const char *data, size_t size, uint64 *original_size);
+
+// Inflates the stream following the header into |out|, which must hold exactly |out_size| bytes.
+bool Inflate(const char *data, size_t size, char *out, uint64 out_size);
+
+// Deflates one file at a time into a sink, so the whole file never has to be in memory.
+class Deflater
+{
+  public:
+    // Receives the compressed bytes, header included. Returning false aborts the file.
+    typedef std::function<bool(const char *data, size_t size)> Sink;
+
+    explicit Deflater(int level);
+    ~Deflater();
+
+    // Starts a file of |original_size| bytes and writes its header.
+    bool Begin(uint64 original_size, const Sink &sink);
+    // Feeds the next piece of the file; |finish| marks the last one.
+    bool Write(const char *data, size_t size, bool finish, const Sink &sink);
+
+  private:
+    z_stream stream_;
+    bool initialized_;
+    std::vector<char> out_;
+};
+
+// Compresses a whole buffer, header included.
+bool Compress(int level, const char *data, size_t size, std::string *out);
+
+} // namespace cloud_compression
+
+#endif // SRC_GREENWORKS_CLOUD_COMPRESSION_H_
@@ -0,0 +1,138 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "greenworks_cloud_sync.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "third_party/zlib/zlib.h"
+
+const char kCloudManifestFileName[] = ".greenworks_sync_manifest";
+
+namespace
+{
+
+const char kManifestHeader[] = "greenworks-sync 1";
+
+const size_t kHashBufferSize = 1024 * 1024;
+const unsigned kMaxHashThreads = 8;
+
+bool HashFile(const std::string &path, std::vector<char> *buffer, CloudManifestEntry *entry)
+{
+    std::ifstream fileStream(path, std::ios::in | std::ios::binary);
+    if (!fileStream.is_open())
+        return false;
+
+    uLong crc = crc32(0L, Z_NULL, 0);
+    uint64 size = 0;
+    while (fileStream)
+    {
+        fileStream.read(buffer->data(), static_cast<std::streamsize>(buffer->size()));
+        std::streamsize read = fileStream.gcount();
+        if (read <= 0)
+            break;
+        crc = crc32(crc, reinterpret_cast<const Bytef *>(buffer->data()), static_cast<uInt>(read));
+        size += static_cast<uint64>(read);
+    }
+    if (fileStream.bad())
+        return false;
+
+    entry->size = size;
+    entry->crc = static_cast<uint32>(crc);
+    return true;
+}
+
+} // namespace
+
+namespace cloud_sync
+{
+
+bool ParseManifest(const std::string &content, CloudManifest *manifest)
+{
+    manifest->clear();
+
+    std::istringstream lines(content);
+    std::string line;
+    if (!std::getline(lines, line) || line != kManifestHeader)
+        return false;
+
+    // <crc in hex> <size> <name>, the name running to the end of the line.
+    while (std::getline(lines, line))
+    {
+        if (line.empty())
+            continue;
+
+        const char *text = line.c_str();
+        char *end;
+        unsigned long crc = strtoul(text, &end, 16);
+        if (*end != ' ')
+        {
+            manifest->clear();
+            return false;
+        }
+        unsigned long long size = strtoull(end + 1, &end, 10);
+        if (*end != ' ' || end[1] == '\0')
+        {
+            manifest->clear();
+            return false;
+        }
+
+        CloudManifestEntry entry;
+        entry.crc = static_cast<uint32>(crc);
+        entry.size = static_cast<uint64>(size);
+        (*manifest)[std::string(end + 1)] = entry;
+    }
+    return true;
+}
+
+std::string SerializeManifest(const CloudManifest &manifest)
+{
+    std::string content = kManifestHeader;
+    content += '\n';
+    for (const auto &entry : manifest)
+    {
+        char prefix[40];
+        snprintf(prefix, sizeof(prefix), "%08x %llu ", entry.second.crc,
+                 static_cast<unsigned long long>(entry.second.size));
+        content += prefix;
+        content += entry.first;
+        content += '\n';
+    }
+    return content;
+}
+
+void HashFiles(const std::vector<std::string> &paths, std::vector<CloudManifestEntry> *entries,
+               std::vector<uint8> *readable)
+{
+    entries->assign(paths.size(), CloudManifestEntry());
+    readable->assign(paths.size(), 0);
+    if (paths.empty())
+        return;
+
+    unsigned threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::min(threadCount, kMaxHashThreads);
+    threadCount = std::min(threadCount, static_cast<unsigned>(paths.size()));
+
+    std::atomic<size_t> next(0);
+    auto hashNext = [&]() {
+        std::vector<char> buffer(kHashBufferSize);
+        for (size_t i = next++; i < paths.size(); i = next++)
+            (*readable)[i] = HashFile(paths[i], &buffer, &(*entries)[i]) ? 1 : 0;
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < threadCount; i++)
+        threads.push_back(std::thread(hashNext));
+    hashNext();
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+} // namespace cloud_sync
@@ -0,0 +1,42 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SRC_GREENWORKS_CLOUD_SYNC_H_
+#define SRC_GREENWORKS_CLOUD_SYNC_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "steam/steam_api.h"
+
+// What the last sync uploaded for one cloud file: the size and CRC-32 of the local content.
+struct CloudManifestEntry
+{
+    uint64 size;
+    uint32 crc;
+};
+
+typedef std::map<std::string, CloudManifestEntry> CloudManifest;
+
+// Cloud file holding the manifest that syncFilesToCloud keeps.
+extern const char kCloudManifestFileName[];
+
+namespace cloud_sync
+{
+
+// Parses a manifest written by SerializeManifest. Returns false, leaving |manifest| empty, for
+// anything else, so a damaged manifest only costs a full upload.
+bool ParseManifest(const std::string &content, CloudManifest *manifest);
+
+std::string SerializeManifest(const CloudManifest &manifest);
+
+// Hashes the files at |paths| with CRC-32 on several threads. |entries| and |readable| get one slot
+// per path; |readable| is 0 where the file could not be read.
+void HashFiles(const std::vector<std::string> &paths, std::vector<CloudManifestEntry> *entries,
+               std::vector<uint8> *readable);
+
+} // namespace cloud_sync
+
+#endif // SRC_GREENWORKS_CLOUD_SYNC_H_
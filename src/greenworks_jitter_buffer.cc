@@ -0,0 +1,148 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "greenworks_jitter_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+
+const SteamNetworkingMicroseconds kMinDepth = 2 * 1000;
+const SteamNetworkingMicroseconds kMaxDepth = 250 * 1000;
+
+// Depth in multiples of the jitter estimate.
+const int kJitterMultiplier = 3;
+
+const SteamNetworkingMicroseconds kBaseWindow = 2 * 1000 * 1000;
+
+const size_t kMaxBuffered = 256;
+
+} // namespace
+
+void JitterBuffer::WriteHeader(SteamNetworkingMicroseconds senderTime, uint8 *out)
+{
+    uint64 value = static_cast<uint64>(senderTime);
+    for (uint32 i = 0; i < kHeaderSize; i++)
+        out[i] = static_cast<uint8>(value >> (8 * i));
+}
+
+JitterBuffer::JitterBuffer()
+    : has_transit_(false), last_transit_(0), jitter16_(0), base_transit_(0), window_min_(0), previous_window_min_(0),
+      window_start_(0), has_released_(false), last_released_(0)
+{
+    memset(&stats_, 0, sizeof(stats_));
+}
+
+JitterBuffer::~JitterBuffer()
+{
+    while (!entries_.empty())
+    {
+        entries_.top().message->Release();
+        entries_.pop();
+    }
+}
+
+void JitterBuffer::Push(SteamNetworkingMessage_t *message)
+{
+    ++stats_.received;
+
+    if (message->m_cbSize < static_cast<int>(kHeaderSize))
+    {
+        Drop(message);
+        return;
+    }
+
+    const uint8 *data = static_cast<const uint8 *>(message->GetData());
+    uint64 value = 0;
+    for (uint32 i = 0; i < kHeaderSize; i++)
+        value |= static_cast<uint64>(data[i]) << (8 * i);
+    SteamNetworkingMicroseconds senderTime = static_cast<SteamNetworkingMicroseconds>(value);
+
+    SteamNetworkingMicroseconds arrival = message->m_usecTimeReceived;
+    SteamNetworkingMicroseconds transit = arrival - senderTime;
+
+    if (!has_transit_)
+    {
+        has_transit_ = true;
+        base_transit_ = window_min_ = previous_window_min_ = transit;
+        window_start_ = arrival;
+    }
+    else
+    {
+        SteamNetworkingMicroseconds d = transit - last_transit_;
+        if (d < 0)
+            d = -d;
+        jitter16_ += d - (jitter16_ + 8) / 16;
+
+        if (arrival - window_start_ > kBaseWindow)
+        {
+            previous_window_min_ = window_min_;
+            window_min_ = transit;
+            window_start_ = arrival;
+        }
+        window_min_ = std::min(window_min_, transit);
+        base_transit_ = std::min(window_min_, previous_window_min_);
+    }
+    last_transit_ = transit;
+
+    if (has_released_ && senderTime <= last_released_)
+    {
+        Drop(message);
+        return;
+    }
+
+    if (arrival > senderTime + base_transit_ + Depth())
+        ++stats_.late;
+
+    if (entries_.size() >= kMaxBuffered)
+    {
+        Entry oldest = entries_.top();
+        entries_.pop();
+        has_released_ = true;
+        last_released_ = oldest.sender_time;
+        Drop(oldest.message);
+    }
+
+    entries_.push({senderTime, message});
+}
+
+SteamNetworkingMessage_t *JitterBuffer::Pop(SteamNetworkingMicroseconds now, SteamNetworkingMicroseconds *senderTime)
+{
+    if (entries_.empty())
+        return nullptr;
+
+    Entry next = entries_.top();
+    if (now < next.sender_time + base_transit_ + Depth())
+        return nullptr;
+
+    entries_.pop();
+    has_released_ = true;
+    last_released_ = next.sender_time;
+    ++stats_.delivered;
+
+    *senderTime = next.sender_time;
+    return next.message;
+}
+
+JitterBuffer::Stats JitterBuffer::GetStats() const
+{
+    Stats stats = stats_;
+    stats.jitter = jitter16_ / 16;
+    stats.depth = Depth();
+    stats.buffered = static_cast<uint32>(entries_.size());
+    return stats;
+}
+
+SteamNetworkingMicroseconds JitterBuffer::Depth() const
+{
+    return std::min(kMaxDepth, std::max(kMinDepth, kJitterMultiplier * jitter16_ / 16));
+}
+
+void JitterBuffer::Drop(SteamNetworkingMessage_t *message)
+{
+    ++stats_.dropped;
+    message->Release();
+}
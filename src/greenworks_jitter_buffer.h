@@ -0,0 +1,92 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SRC_GREENWORKS_JITTER_BUFFER_H_
+#define SRC_GREENWORKS_JITTER_BUFFER_H_
+
+#include <queue>
+#include <vector>
+
+#include "steam/steamnetworkingtypes.h"
+
+// Evens out the arrival of time-stamped messages from one peer on one channel.
+//
+// Every message starts with the sender's SteamNetworkingUtils()->GetLocalTimestamp() as an int64.
+// Messages are released in sender order once now >= sender time + base transit + depth, where base
+// transit is the smallest recent (arrival - sender time) and depth follows the RFC 3550 interarrival
+// jitter estimate. The two clocks never have to agree: their offset is part of the base transit.
+class JitterBuffer
+{
+  public:
+    struct Stats
+    {
+        uint64 received;
+        uint64 delivered;
+        // Arrived after their playout time; still delivered, right away.
+        uint64 late;
+        // Arrived after a newer message had been delivered, malformed, or pushed out of a full buffer.
+        uint64 dropped;
+        SteamNetworkingMicroseconds jitter;
+        SteamNetworkingMicroseconds depth;
+        uint32 buffered;
+    };
+
+    static const uint32 kHeaderSize = 8;
+
+    static void WriteHeader(SteamNetworkingMicroseconds senderTime, uint8 *out);
+
+    JitterBuffer();
+    ~JitterBuffer();
+
+    JitterBuffer(const JitterBuffer &) = delete;
+    JitterBuffer &operator=(const JitterBuffer &) = delete;
+
+    // Takes ownership of |message|.
+    void Push(SteamNetworkingMessage_t *message);
+
+    // Returns the next message due at |now|, or nullptr. The caller releases it; its payload starts
+    // kHeaderSize bytes into the message data.
+    SteamNetworkingMessage_t *Pop(SteamNetworkingMicroseconds now, SteamNetworkingMicroseconds *senderTime);
+
+    Stats GetStats() const;
+
+  private:
+    struct Entry
+    {
+        SteamNetworkingMicroseconds sender_time;
+        SteamNetworkingMessage_t *message;
+    };
+
+    struct SentLater
+    {
+        bool operator()(const Entry &a, const Entry &b) const
+        {
+            return a.sender_time > b.sender_time;
+        }
+    };
+
+    SteamNetworkingMicroseconds Depth() const;
+    void Drop(SteamNetworkingMessage_t *message);
+
+    std::priority_queue<Entry, std::vector<Entry>, SentLater> entries_;
+
+    bool has_transit_;
+    SteamNetworkingMicroseconds last_transit_;
+    // RFC 3550 estimate, scaled by 16 to keep precision in integer math.
+    SteamNetworkingMicroseconds jitter16_;
+
+    // Minimum transit over the current and the previous window, so the base follows clock drift and
+    // route changes.
+    SteamNetworkingMicroseconds base_transit_;
+    SteamNetworkingMicroseconds window_min_;
+    SteamNetworkingMicroseconds previous_window_min_;
+    SteamNetworkingMicroseconds window_start_;
+
+    bool has_released_;
+    SteamNetworkingMicroseconds last_released_;
+
+    Stats stats_;
+};
+
+#endif // SRC_GREENWORKS_JITTER_BUFFER_H_
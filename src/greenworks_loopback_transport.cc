@@ -0,0 +1,395 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "greenworks_loopback_transport.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+
+// Fake individual-account Steam IDs, well above any account id handed out so far.
+const uint64 kLoopbackSteamIdBase = 76561197960265728ULL + 0x7fff0000ULL;
+
+// Channel the legacy P2P calls are queued on; ISteamNetworkingMessages channels are never negative.
+const int kLoopbackP2PChannel = -1;
+
+// Mirrors the send buffer size set in Initialize().
+const int64 kLoopbackSendBufferSize = 0x1000000;
+
+// Upper bound of retransmits simulated for one reliable message.
+const int kLoopbackMaxRetransmits = 10;
+
+void ReleaseLoopbackMessage(SteamNetworkingMessage_t *message)
+{
+    LoopbackMessage *loopbackMessage = static_cast<LoopbackMessage *>(message);
+    delete[] static_cast<uint8 *>(loopbackMessage->m_pData);
+    delete loopbackMessage;
+}
+
+SteamNetworkingMicroseconds Now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+} // namespace
+
+LoopbackMessageQueue::LoopbackMessageQueue() : head_(&stub_), tail_(&stub_)
+{
+    stub_.next.store(nullptr, std::memory_order_relaxed);
+}
+
+void LoopbackMessageQueue::Push(LoopbackMessage *message)
+{
+    message->next.store(nullptr, std::memory_order_relaxed);
+    LoopbackMessage *previous = head_.exchange(message, std::memory_order_acq_rel);
+    previous->next.store(message, std::memory_order_release);
+}
+
+LoopbackMessage *LoopbackMessageQueue::Pop()
+{
+    LoopbackMessage *tail = tail_;
+    LoopbackMessage *next = tail->next.load(std::memory_order_acquire);
+
+    if (tail == &stub_)
+    {
+        if (next == nullptr)
+            return nullptr;
+        tail_ = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+
+    if (next != nullptr)
+    {
+        tail_ = next;
+        return tail;
+    }
+
+    // A producer is between the exchange and linking its node; pick it up next time.
+    if (tail != head_.load(std::memory_order_acquire))
+        return nullptr;
+
+    Push(&stub_);
+
+    next = tail->next.load(std::memory_order_acquire);
+    if (next != nullptr)
+    {
+        tail_ = next;
+        return tail;
+    }
+    return nullptr;
+}
+
+LoopbackTransport::LoopbackTransport(LoopbackNetwork *network, uint64 steamId, const LoopbackLinkConfig &config)
+    : network_(network), steam_id_(steamId), random_(static_cast<uint32>(steamId)), link_free_at_(0)
+{
+    SetLinkConfig(config);
+}
+
+LoopbackTransport::~LoopbackTransport()
+{
+    while (LoopbackMessage *message = inbound_.Pop())
+        ReleaseLoopbackMessage(message);
+
+    for (auto &pending : pending_)
+    {
+        while (!pending.second.empty())
+        {
+            ReleaseLoopbackMessage(pending.second.top());
+            pending.second.pop();
+        }
+    }
+}
+
+void LoopbackTransport::SetLinkConfig(const LoopbackLinkConfig &config)
+{
+    latency_us_ = config.latency_ms * 1000;
+    jitter_us_ = config.jitter_ms * 1000;
+    loss_ = config.loss;
+    bandwidth_ = config.bandwidth;
+}
+
+EResult LoopbackTransport::Send(uint64 steamIdRemote, const void *data, uint32 size, bool reliable, int channel)
+{
+    if (size > static_cast<uint32>(k_cbMaxSteamNetworkingSocketsMessageSizeSend))
+        return k_EResultInvalidParam;
+
+    LoopbackTransport *remote = network_->FindPeer(steamIdRemote);
+    if (remote == nullptr)
+        return k_EResultNoConnection;
+
+    SteamNetworkingMicroseconds now = Now();
+    int latency = latency_us_;
+    int jitter = jitter_us_;
+    double loss = loss_;
+    int bandwidth = bandwidth_;
+
+    // Bandwidth cap: messages leave the sender one after another.
+    SteamNetworkingMicroseconds departure = link_free_at_ > now ? link_free_at_ : now;
+    if (bandwidth > 0)
+    {
+        if ((departure - now) * bandwidth / 1000000 + size > kLoopbackSendBufferSize)
+            return k_EResultLimitExceeded;
+        link_free_at_ = departure + static_cast<SteamNetworkingMicroseconds>(size) * 1000000 / bandwidth;
+    }
+
+    LoopbackNetwork::Stats &stats = network_->GetStats();
+    stats.messages_sent++;
+    stats.bytes_sent += size;
+
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    SteamNetworkingMicroseconds delay = latency;
+    if (jitter > 0)
+    {
+        delay += std::uniform_int_distribution<int>(-jitter, jitter)(random_);
+        if (delay < 0)
+            delay = 0;
+    }
+
+    if (reliable)
+    {
+        // Every lost transmission costs another round trip.
+        for (int i = 0; i < kLoopbackMaxRetransmits && loss > 0 && chance(random_) < loss; ++i)
+            delay += 2 * latency + jitter;
+    }
+    else if (loss > 0 && chance(random_) < loss)
+    {
+        stats.messages_dropped++;
+        return k_EResultOK;
+    }
+
+    SteamNetworkingMicroseconds deliver = departure + delay;
+    if (reliable)
+    {
+        // Reliable messages on a channel arrive in order.
+        SteamNetworkingMicroseconds &last = last_reliable_delivery_[std::make_pair(steamIdRemote, channel)];
+        if (deliver < last)
+            deliver = last;
+        last = deliver;
+    }
+
+    LoopbackMessage *message = new LoopbackMessage();
+    message->m_pData = new uint8[size > 0 ? size : 1];
+    memcpy(message->m_pData, data, size);
+    message->m_cbSize = static_cast<int>(size);
+    message->m_identityPeer.SetSteamID64(steam_id_);
+    message->m_nMessageNumber = ++next_message_number_[steamIdRemote];
+    message->m_pfnRelease = ReleaseLoopbackMessage;
+    message->m_nChannel = channel;
+    message->m_nFlags = reliable ? k_nSteamNetworkingSend_Reliable : k_nSteamNetworkingSend_Unreliable;
+    message->time_sent = now;
+    message->time_deliver = deliver;
+    message->order = network_->NextOrder();
+
+    remote->inbound_.Push(message);
+
+    return k_EResultOK;
+}
+
+LoopbackMessage *LoopbackTransport::PeekReady(int channel)
+{
+    while (LoopbackMessage *message = inbound_.Pop())
+        pending_[message->m_nChannel].push(message);
+
+    auto pending = pending_.find(channel);
+    if (pending == pending_.end() || pending->second.empty())
+        return nullptr;
+
+    LoopbackMessage *message = pending->second.top();
+    return message->time_deliver <= Now() ? message : nullptr;
+}
+
+SteamNetworkingMicroseconds LoopbackTransport::GetQueuedTime(SteamNetworkingMicroseconds now) const
+{
+    return link_free_at_ > now ? link_free_at_ - now : 0;
+}
+
+EResult LoopbackTransport::SendMessageToUser(const SteamNetworkingIdentity &identityRemote, const void *data,
+                                             uint32 size, int sendFlags, int channel)
+{
+    return Send(identityRemote.GetSteamID64(), data, size, (sendFlags & k_nSteamNetworkingSend_Reliable) != 0,
+                channel);
+}
+
+int LoopbackTransport::ReceiveMessagesOnChannel(int channel, SteamNetworkingMessage_t **messages, int maxMessages)
+{
+    LoopbackNetwork::Stats &stats = network_->GetStats();
+
+    int count = 0;
+    while (count < maxMessages)
+    {
+        LoopbackMessage *message = PeekReady(channel);
+        if (message == nullptr)
+            break;
+        pending_[channel].pop();
+
+        message->m_usecTimeReceived = Now();
+        stats.messages_delivered++;
+        stats.bytes_delivered += message->m_cbSize;
+        stats.latency_us += message->m_usecTimeReceived - message->time_sent;
+
+        messages[count++] = message;
+    }
+    return count;
+}
+
+bool LoopbackTransport::AcceptSessionWithUser(const SteamNetworkingIdentity &identityRemote)
+{
+    return network_->FindPeer(identityRemote.GetSteamID64()) != nullptr;
+}
+
+bool LoopbackTransport::CloseSessionWithUser(const SteamNetworkingIdentity &identityRemote)
+{
+    return network_->FindPeer(identityRemote.GetSteamID64()) != nullptr;
+}
+
+ESteamNetworkingConnectionState LoopbackTransport::GetSessionConnectionInfo(
+    const SteamNetworkingIdentity &identityRemote, SteamNetConnectionInfo_t *connectionInfo,
+    SteamNetConnectionRealTimeStatus_t *status)
+{
+    ESteamNetworkingConnectionState state = network_->FindPeer(identityRemote.GetSteamID64()) != nullptr
+                                                ? k_ESteamNetworkingConnectionState_Connected
+                                                : k_ESteamNetworkingConnectionState_None;
+
+    if (connectionInfo != nullptr)
+    {
+        memset(connectionInfo, 0, sizeof(*connectionInfo));
+        connectionInfo->m_identityRemote = identityRemote;
+        connectionInfo->m_eState = state;
+        snprintf(connectionInfo->m_szConnectionDescription, sizeof(connectionInfo->m_szConnectionDescription),
+                 "loopback");
+    }
+
+    if (status != nullptr)
+    {
+        SteamNetworkingMicroseconds queueTime = GetQueuedTime(Now());
+        int bandwidth = bandwidth_;
+        float quality = static_cast<float>(1.0 - static_cast<double>(loss_));
+
+        memset(status, 0, sizeof(*status));
+        status->m_eState = state;
+        status->m_nPing = 2 * latency_us_ / 1000;
+        status->m_flConnectionQualityLocal = quality;
+        status->m_flConnectionQualityRemote = quality;
+        status->m_nSendRateBytesPerSecond = bandwidth > 0 ? bandwidth : 0x7fffffff;
+        status->m_cbPendingReliable = static_cast<int>(queueTime * bandwidth / 1000000);
+        status->m_usecQueueTime = queueTime;
+    }
+
+    return state;
+}
+
+bool LoopbackTransport::SendP2PPacket(CSteamID steamIdRemote, const void *data, uint32 size, EP2PSend sendType)
+{
+    bool reliable = sendType == k_EP2PSendReliable;
+    return Send(steamIdRemote.ConvertToUint64(), data, size, reliable, kLoopbackP2PChannel) == k_EResultOK;
+}
+
+bool LoopbackTransport::IsP2PPacketAvailable(uint32 *messageSize)
+{
+    LoopbackMessage *message = PeekReady(kLoopbackP2PChannel);
+    if (message == nullptr)
+        return false;
+
+    *messageSize = static_cast<uint32>(message->m_cbSize);
+    return true;
+}
+
+bool LoopbackTransport::ReadP2PPacket(void *dest, uint32 destSize, uint32 *messageSize, CSteamID *steamIdRemote)
+{
+    SteamNetworkingMessage_t *message;
+    if (ReceiveMessagesOnChannel(kLoopbackP2PChannel, &message, 1) != 1)
+        return false;
+
+    uint32 size = static_cast<uint32>(message->m_cbSize);
+    memcpy(dest, message->m_pData, size < destSize ? size : destSize);
+    *messageSize = size;
+    *steamIdRemote = message->m_identityPeer.GetSteamID();
+
+    message->Release();
+    return true;
+}
+
+bool LoopbackTransport::AcceptP2PSessionWithUser(CSteamID steamIdRemote)
+{
+    return network_->FindPeer(steamIdRemote.ConvertToUint64()) != nullptr;
+}
+
+bool LoopbackTransport::CloseP2PSessionWithUser(CSteamID steamIdRemote)
+{
+    return network_->FindPeer(steamIdRemote.ConvertToUint64()) != nullptr;
+}
+
+bool LoopbackTransport::GetP2PSessionState(CSteamID steamIdRemote, P2PSessionState_t *sessionState)
+{
+    if (network_->FindPeer(steamIdRemote.ConvertToUint64()) == nullptr)
+        return false;
+
+    SteamNetworkingMicroseconds queueTime = GetQueuedTime(Now());
+
+    memset(sessionState, 0, sizeof(*sessionState));
+    sessionState->m_bConnectionActive = 1;
+    sessionState->m_nBytesQueuedForSend = static_cast<int32>(queueTime * bandwidth_ / 1000000);
+    return true;
+}
+
+SteamNetworkingMicroseconds LoopbackTransport::GetLocalTimestamp()
+{
+    return Now();
+}
+
+LoopbackNetwork::LoopbackNetwork(const LoopbackLinkConfig &config)
+    : config_(config), peer_count_(0), next_order_(0)
+{
+    stats_.messages_sent = 0;
+    stats_.messages_delivered = 0;
+    stats_.messages_dropped = 0;
+    stats_.bytes_sent = 0;
+    stats_.bytes_delivered = 0;
+    stats_.latency_us = 0;
+}
+
+LoopbackNetwork::~LoopbackNetwork()
+{
+}
+
+LoopbackTransport *LoopbackNetwork::CreatePeer()
+{
+    std::lock_guard<std::mutex> lock(create_mutex_);
+
+    int index = peer_count_.load(std::memory_order_relaxed);
+    if (index >= MAX_LOOPBACK_PEERS)
+        return nullptr;
+
+    peers_[index].reset(new LoopbackTransport(this, kLoopbackSteamIdBase + index, config_));
+    // Publishes the peer to senders looking it up without the lock.
+    peer_count_.store(index + 1, std::memory_order_release);
+    return peers_[index].get();
+}
+
+LoopbackTransport *LoopbackNetwork::FindPeer(uint64 steamId)
+{
+    if (steamId < kLoopbackSteamIdBase)
+        return nullptr;
+
+    uint64 index = steamId - kLoopbackSteamIdBase;
+    if (index >= static_cast<uint64>(peer_count_.load(std::memory_order_acquire)))
+        return nullptr;
+
+    return peers_[index].get();
+}
+
+void LoopbackNetwork::SetLinkConfig(const LoopbackLinkConfig &config)
+{
+    std::lock_guard<std::mutex> lock(create_mutex_);
+
+    config_ = config;
+    for (int i = 0; i < peer_count_.load(std::memory_order_relaxed); ++i)
+        peers_[i]->SetLinkConfig(config);
+}
@@ -0,0 +1,166 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SRC_GREENWORKS_LOOPBACK_TRANSPORT_H_
+#define SRC_GREENWORKS_LOOPBACK_TRANSPORT_H_
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "greenworks_networking_transport.h"
+
+#define MAX_LOOPBACK_PEERS 64
+
+struct LoopbackLinkConfig
+{
+    int latency_ms;
+    int jitter_ms;
+    // Probability in [0, 1]. Unreliable messages are dropped, reliable ones pay a retransmit.
+    double loss;
+    // Bytes per second leaving the sending peer, 0 for unlimited.
+    int bandwidth;
+};
+
+struct LoopbackMessage : public SteamNetworkingMessage_t
+{
+    std::atomic<LoopbackMessage *> next;
+    SteamNetworkingMicroseconds time_sent;
+    SteamNetworkingMicroseconds time_deliver;
+    uint64 order;
+};
+
+// Intrusive multi-producer single-consumer queue (Vyukov). Any thread may push; only the owning
+// peer pops.
+class LoopbackMessageQueue
+{
+  public:
+    LoopbackMessageQueue();
+
+    void Push(LoopbackMessage *message);
+    LoopbackMessage *Pop();
+
+  private:
+    std::atomic<LoopbackMessage *> head_;
+    LoopbackMessage *tail_;
+    LoopbackMessage stub_;
+};
+
+class LoopbackNetwork;
+
+// One in-process peer. A peer may be driven from any thread, but only from one thread at a time.
+class LoopbackTransport : public NetworkingTransport
+{
+  public:
+    LoopbackTransport(LoopbackNetwork *network, uint64 steamId, const LoopbackLinkConfig &config);
+    ~LoopbackTransport();
+
+    uint64 GetSteamID64() const
+    {
+        return steam_id_;
+    }
+
+    void SetLinkConfig(const LoopbackLinkConfig &config);
+
+    EResult SendMessageToUser(const SteamNetworkingIdentity &identityRemote, const void *data, uint32 size,
+                              int sendFlags, int channel) override;
+    int ReceiveMessagesOnChannel(int channel, SteamNetworkingMessage_t **messages, int maxMessages) override;
+    bool AcceptSessionWithUser(const SteamNetworkingIdentity &identityRemote) override;
+    bool CloseSessionWithUser(const SteamNetworkingIdentity &identityRemote) override;
+    ESteamNetworkingConnectionState GetSessionConnectionInfo(const SteamNetworkingIdentity &identityRemote,
+                                                             SteamNetConnectionInfo_t *connectionInfo,
+                                                             SteamNetConnectionRealTimeStatus_t *status) override;
+
+    bool SendP2PPacket(CSteamID steamIdRemote, const void *data, uint32 size, EP2PSend sendType) override;
+    bool IsP2PPacketAvailable(uint32 *messageSize) override;
+    bool ReadP2PPacket(void *dest, uint32 destSize, uint32 *messageSize, CSteamID *steamIdRemote) override;
+    bool AcceptP2PSessionWithUser(CSteamID steamIdRemote) override;
+    bool CloseP2PSessionWithUser(CSteamID steamIdRemote) override;
+    bool GetP2PSessionState(CSteamID steamIdRemote, P2PSessionState_t *sessionState) override;
+
+    SteamNetworkingMicroseconds GetLocalTimestamp() override;
+
+  private:
+    struct DeliverLater
+    {
+        bool operator()(const LoopbackMessage *a, const LoopbackMessage *b) const
+        {
+            return a->time_deliver != b->time_deliver ? a->time_deliver > b->time_deliver : a->order > b->order;
+        }
+    };
+    typedef std::priority_queue<LoopbackMessage *, std::vector<LoopbackMessage *>, DeliverLater> PendingQueue;
+
+    EResult Send(uint64 steamIdRemote, const void *data, uint32 size, bool reliable, int channel);
+    LoopbackMessage *PeekReady(int channel);
+    SteamNetworkingMicroseconds GetQueuedTime(SteamNetworkingMicroseconds now) const;
+
+    LoopbackNetwork *network_;
+    uint64 steam_id_;
+
+    std::atomic<int> latency_us_;
+    std::atomic<int> jitter_us_;
+    std::atomic<double> loss_;
+    std::atomic<int> bandwidth_;
+
+    // Sender side.
+    std::mt19937 random_;
+    SteamNetworkingMicroseconds link_free_at_;
+    std::map<std::pair<uint64, int>, SteamNetworkingMicroseconds> last_reliable_delivery_;
+    std::map<uint64, int64> next_message_number_;
+
+    // Receiver side.
+    LoopbackMessageQueue inbound_;
+    std::map<int, PendingQueue> pending_;
+};
+
+// A set of in-process peers exchanging messages with simulated latency, jitter, loss and bandwidth.
+class LoopbackNetwork
+{
+  public:
+    struct Stats
+    {
+        std::atomic<uint64> messages_sent;
+        std::atomic<uint64> messages_delivered;
+        std::atomic<uint64> messages_dropped;
+        std::atomic<uint64> bytes_sent;
+        std::atomic<uint64> bytes_delivered;
+        // Sum of send-to-receive times of delivered messages.
+        std::atomic<uint64> latency_us;
+    };
+
+    explicit LoopbackNetwork(const LoopbackLinkConfig &config);
+    ~LoopbackNetwork();
+
+    // Returns nullptr once MAX_LOOPBACK_PEERS peers exist.
+    LoopbackTransport *CreatePeer();
+    LoopbackTransport *FindPeer(uint64 steamId);
+
+    // Applies to every existing peer and to peers created later.
+    void SetLinkConfig(const LoopbackLinkConfig &config);
+
+    Stats &GetStats()
+    {
+        return stats_;
+    }
+
+    uint64 NextOrder()
+    {
+        return next_order_++;
+    }
+
+  private:
+    std::mutex create_mutex_;
+    LoopbackLinkConfig config_;
+    std::array<std::unique_ptr<LoopbackTransport>, MAX_LOOPBACK_PEERS> peers_;
+    std::atomic<int> peer_count_;
+    std::atomic<uint64> next_order_;
+    Stats stats_;
+};
+
+#endif // SRC_GREENWORKS_LOOPBACK_TRANSPORT_H_
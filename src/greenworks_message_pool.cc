@@ -0,0 +1,100 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "greenworks_message_pool.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+
+// Smallest size class is 1 << kMinSizeShift bytes.
+const size_t kMinSizeShift = 12;
+
+// Each buffer is preceded by its size class so Release() needs nothing but the pointer. Keeps
+// the data 16 byte aligned.
+const size_t kBufferHeaderSize = 16;
+
+} // namespace
+
+MessageBufferPool::MessageBufferPool(size_t max_pooled_bytes) : max_pooled_bytes_(max_pooled_bytes)
+{
+    memset(&stats_, 0, sizeof(stats_));
+}
+
+MessageBufferPool::~MessageBufferPool()
+{
+    for (auto &buffers : free_)
+    {
+        for (uint8 *buffer : buffers)
+            free(buffer - kBufferHeaderSize);
+    }
+}
+
+size_t MessageBufferPool::SizeClass(size_t size)
+{
+    size_t size_class = 0;
+    while ((static_cast<size_t>(1) << (size_class + kMinSizeShift)) < size)
+        ++size_class;
+    return size_class;
+}
+
+uint8 *MessageBufferPool::Acquire(size_t size, size_t *capacity)
+{
+    size_t size_class = SizeClass(size);
+    *capacity = static_cast<size_t>(1) << (size_class + kMinSizeShift);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.outstanding;
+        if (size_class < free_.size() && !free_[size_class].empty())
+        {
+            uint8 *buffer = free_[size_class].back();
+            free_[size_class].pop_back();
+            stats_.pooled_bytes -= *capacity;
+            ++stats_.reuses;
+            return buffer;
+        }
+        ++stats_.allocations;
+    }
+
+    uint8 *block = static_cast<uint8 *>(malloc(kBufferHeaderSize + *capacity));
+    if (block == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --stats_.outstanding;
+        return nullptr;
+    }
+    memcpy(block, &size_class, sizeof(size_class));
+    return block + kBufferHeaderSize;
+}
+
+void MessageBufferPool::Release(uint8 *buffer)
+{
+    size_t size_class;
+    memcpy(&size_class, buffer - kBufferHeaderSize, sizeof(size_class));
+    size_t capacity = static_cast<size_t>(1) << (size_class + kMinSizeShift);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --stats_.outstanding;
+        if (stats_.pooled_bytes + capacity <= max_pooled_bytes_)
+        {
+            if (free_.size() <= size_class)
+                free_.resize(size_class + 1);
+            free_[size_class].push_back(buffer);
+            stats_.pooled_bytes += capacity;
+            return;
+        }
+    }
+
+    free(buffer - kBufferHeaderSize);
+}
+
+MessageBufferPool::Stats MessageBufferPool::GetStats()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
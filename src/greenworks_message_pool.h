@@ -0,0 +1,50 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SRC_GREENWORKS_MESSAGE_POOL_H_
+#define SRC_GREENWORKS_MESSAGE_POOL_H_
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "steam/steamtypes.h"
+
+// Recycles large native buffers that JS fills in place and hands to the send bindings. Buffers are
+// grouped into power-of-two size classes; freed buffers are kept until |max_pooled_bytes| is
+// reached. Thread safe.
+class MessageBufferPool
+{
+  public:
+    struct Stats
+    {
+        // Buffers that had to be allocated, and buffers served from the pool.
+        uint64 allocations;
+        uint64 reuses;
+        // Buffers handed out and not released yet.
+        uint64 outstanding;
+        // Bytes held by free buffers.
+        uint64 pooled_bytes;
+    };
+
+    explicit MessageBufferPool(size_t max_pooled_bytes);
+    ~MessageBufferPool();
+
+    // Returns a buffer of at least |size| bytes; its real size is stored in |capacity|. The contents
+    // are left uninitialized.
+    uint8 *Acquire(size_t size, size_t *capacity);
+    void Release(uint8 *buffer);
+
+    Stats GetStats();
+
+  private:
+    static size_t SizeClass(size_t size);
+
+    std::mutex mutex_;
+    size_t max_pooled_bytes_;
+    std::vector<std::vector<uint8 *>> free_;
+    Stats stats_;
+};
+
+#endif // SRC_GREENWORKS_MESSAGE_POOL_H_
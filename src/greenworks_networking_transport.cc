@@ -0,0 +1,231 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "greenworks_networking_transport.h"
+
+namespace
+{
+
+// Legacy P2P packets have no channel; reported like the capture files record them.
+const int kP2PChannel = -1;
+
+// Sits on top of the layer and the base transport and reports every message sent or received.
+class ObservedTransport : public NetworkingTransportLayer
+{
+  public:
+    ObservedTransport() : observer_(nullptr)
+    {
+    }
+
+    void SetObserver(NetworkingActivityObserver observer)
+    {
+        observer_ = observer;
+    }
+
+    EResult SendMessageToUser(const SteamNetworkingIdentity &identityRemote, const void *data, uint32 size,
+                              int sendFlags, int channel) override
+    {
+        EResult result = inner_->SendMessageToUser(identityRemote, data, size, sendFlags, channel);
+        if (result == k_EResultOK)
+            observer_(identityRemote.GetSteamID64(), channel);
+        return result;
+    }
+
+    int ReceiveMessagesOnChannel(int channel, SteamNetworkingMessage_t **messages, int maxMessages) override
+    {
+        int messageCount = inner_->ReceiveMessagesOnChannel(channel, messages, maxMessages);
+        for (int i = 0; i < messageCount; i++)
+            observer_(messages[i]->m_identityPeer.GetSteamID64(), channel);
+        return messageCount;
+    }
+
+    bool SendP2PPacket(CSteamID steamIdRemote, const void *data, uint32 size, EP2PSend sendType) override
+    {
+        bool sent = inner_->SendP2PPacket(steamIdRemote, data, size, sendType);
+        if (sent)
+            observer_(steamIdRemote.ConvertToUint64(), kP2PChannel);
+        return sent;
+    }
+
+    bool ReadP2PPacket(void *dest, uint32 destSize, uint32 *messageSize, CSteamID *steamIdRemote) override
+    {
+        bool success = inner_->ReadP2PPacket(dest, destSize, messageSize, steamIdRemote);
+        if (success)
+            observer_(steamIdRemote->ConvertToUint64(), kP2PChannel);
+        return success;
+    }
+
+  private:
+    NetworkingActivityObserver observer_;
+};
+
+SteamNetworkingTransport steamNetworkingTransport;
+NetworkingTransport *baseTransport = &steamNetworkingTransport;
+NetworkingTransportLayer *transportLayer = nullptr;
+ObservedTransport observedTransport;
+bool observed = false;
+
+} // namespace
+
+EResult SteamNetworkingTransport::SendMessageToUser(const SteamNetworkingIdentity &identityRemote, const void *data,
+                                                    uint32 size, int sendFlags, int channel)
+{
+    return SteamNetworkingMessages()->SendMessageToUser(identityRemote, data, size, sendFlags, channel);
+}
+
+int SteamNetworkingTransport::ReceiveMessagesOnChannel(int channel, SteamNetworkingMessage_t **messages,
+                                                       int maxMessages)
+{
+    return SteamNetworkingMessages()->ReceiveMessagesOnChannel(channel, messages, maxMessages);
+}
+
+bool SteamNetworkingTransport::AcceptSessionWithUser(const SteamNetworkingIdentity &identityRemote)
+{
+    return SteamNetworkingMessages()->AcceptSessionWithUser(identityRemote);
+}
+
+bool SteamNetworkingTransport::CloseSessionWithUser(const SteamNetworkingIdentity &identityRemote)
+{
+    return SteamNetworkingMessages()->CloseSessionWithUser(identityRemote);
+}
+
+ESteamNetworkingConnectionState SteamNetworkingTransport::GetSessionConnectionInfo(
+    const SteamNetworkingIdentity &identityRemote, SteamNetConnectionInfo_t *connectionInfo,
+    SteamNetConnectionRealTimeStatus_t *status)
+{
+    return SteamNetworkingMessages()->GetSessionConnectionInfo(identityRemote, connectionInfo, status);
+}
+
+bool SteamNetworkingTransport::SendP2PPacket(CSteamID steamIdRemote, const void *data, uint32 size, EP2PSend sendType)
+{
+    return SteamNetworking()->SendP2PPacket(steamIdRemote, data, size, sendType);
+}
+
+bool SteamNetworkingTransport::IsP2PPacketAvailable(uint32 *messageSize)
+{
+    return SteamNetworking()->IsP2PPacketAvailable(messageSize);
+}
+
+bool SteamNetworkingTransport::ReadP2PPacket(void *dest, uint32 destSize, uint32 *messageSize, CSteamID *steamIdRemote)
+{
+    return SteamNetworking()->ReadP2PPacket(dest, destSize, messageSize, steamIdRemote);
+}
+
+bool SteamNetworkingTransport::AcceptP2PSessionWithUser(CSteamID steamIdRemote)
+{
+    return SteamNetworking()->AcceptP2PSessionWithUser(steamIdRemote);
+}
+
+bool SteamNetworkingTransport::CloseP2PSessionWithUser(CSteamID steamIdRemote)
+{
+    return SteamNetworking()->CloseP2PSessionWithUser(steamIdRemote);
+}
+
+bool SteamNetworkingTransport::GetP2PSessionState(CSteamID steamIdRemote, P2PSessionState_t *sessionState)
+{
+    return SteamNetworking()->GetP2PSessionState(steamIdRemote, sessionState);
+}
+
+SteamNetworkingMicroseconds SteamNetworkingTransport::GetLocalTimestamp()
+{
+    return SteamNetworkingUtils()->GetLocalTimestamp();
+}
+
+EResult NetworkingTransportLayer::SendMessageToUser(const SteamNetworkingIdentity &identityRemote, const void *data,
+                                                    uint32 size, int sendFlags, int channel)
+{
+    return inner_->SendMessageToUser(identityRemote, data, size, sendFlags, channel);
+}
+
+int NetworkingTransportLayer::ReceiveMessagesOnChannel(int channel, SteamNetworkingMessage_t **messages,
+                                                       int maxMessages)
+{
+    return inner_->ReceiveMessagesOnChannel(channel, messages, maxMessages);
+}
+
+bool NetworkingTransportLayer::AcceptSessionWithUser(const SteamNetworkingIdentity &identityRemote)
+{
+    return inner_->AcceptSessionWithUser(identityRemote);
+}
+
+bool NetworkingTransportLayer::CloseSessionWithUser(const SteamNetworkingIdentity &identityRemote)
+{
+    return inner_->CloseSessionWithUser(identityRemote);
+}
+
+ESteamNetworkingConnectionState NetworkingTransportLayer::GetSessionConnectionInfo(
+    const SteamNetworkingIdentity &identityRemote, SteamNetConnectionInfo_t *connectionInfo,
+    SteamNetConnectionRealTimeStatus_t *status)
+{
+    return inner_->GetSessionConnectionInfo(identityRemote, connectionInfo, status);
+}
+
+bool NetworkingTransportLayer::SendP2PPacket(CSteamID steamIdRemote, const void *data, uint32 size, EP2PSend sendType)
+{
+    return inner_->SendP2PPacket(steamIdRemote, data, size, sendType);
+}
+
+bool NetworkingTransportLayer::IsP2PPacketAvailable(uint32 *messageSize)
+{
+    return inner_->IsP2PPacketAvailable(messageSize);
+}
+
+bool NetworkingTransportLayer::ReadP2PPacket(void *dest, uint32 destSize, uint32 *messageSize, CSteamID *steamIdRemote)
+{
+    return inner_->ReadP2PPacket(dest, destSize, messageSize, steamIdRemote);
+}
+
+bool NetworkingTransportLayer::AcceptP2PSessionWithUser(CSteamID steamIdRemote)
+{
+    return inner_->AcceptP2PSessionWithUser(steamIdRemote);
+}
+
+bool NetworkingTransportLayer::CloseP2PSessionWithUser(CSteamID steamIdRemote)
+{
+    return inner_->CloseP2PSessionWithUser(steamIdRemote);
+}
+
+bool NetworkingTransportLayer::GetP2PSessionState(CSteamID steamIdRemote, P2PSessionState_t *sessionState)
+{
+    return inner_->GetP2PSessionState(steamIdRemote, sessionState);
+}
+
+SteamNetworkingMicroseconds NetworkingTransportLayer::GetLocalTimestamp()
+{
+    return inner_->GetLocalTimestamp();
+}
+
+NetworkingTransport *GetNetworkingTransport()
+{
+    NetworkingTransport *transport = transportLayer != nullptr ? transportLayer : baseTransport;
+    if (!observed)
+        return transport;
+    observedTransport.SetInner(transport);
+    return &observedTransport;
+}
+
+void SetNetworkingActivityObserver(NetworkingActivityObserver observer)
+{
+    observedTransport.SetObserver(observer);
+    observed = observer != nullptr;
+}
+
+void SetNetworkingTransport(NetworkingTransport *transport)
+{
+    baseTransport = transport != nullptr ? transport : &steamNetworkingTransport;
+    if (transportLayer != nullptr)
+        transportLayer->SetInner(baseTransport);
+}
+
+void SetNetworkingTransportLayer(NetworkingTransportLayer *layer)
+{
+    transportLayer = layer;
+    if (transportLayer != nullptr)
+        transportLayer->SetInner(baseTransport);
+}
+
+NetworkingTransportLayer *GetNetworkingTransportLayer()
+{
+    return transportLayer;
+}
@@ -0,0 +1,117 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SRC_GREENWORKS_NETWORKING_TRANSPORT_H_
+#define SRC_GREENWORKS_NETWORKING_TRANSPORT_H_
+
+#include "steam/isteamnetworkingutils.h"
+#include "steam/steam_api.h"
+#include "steam/steamnetworkingtypes.h"
+
+// The subset of ISteamNetworkingMessages and the legacy ISteamNetworking P2P API used by the
+// networking bindings. The bindings always go through the current transport so that Steam can be
+// swapped for an in-process backend without touching JS.
+class NetworkingTransport
+{
+  public:
+    virtual ~NetworkingTransport()
+    {
+    }
+
+    virtual EResult SendMessageToUser(const SteamNetworkingIdentity &identityRemote, const void *data, uint32 size,
+                                      int sendFlags, int channel) = 0;
+    virtual int ReceiveMessagesOnChannel(int channel, SteamNetworkingMessage_t **messages, int maxMessages) = 0;
+    virtual bool AcceptSessionWithUser(const SteamNetworkingIdentity &identityRemote) = 0;
+    virtual bool CloseSessionWithUser(const SteamNetworkingIdentity &identityRemote) = 0;
+    virtual ESteamNetworkingConnectionState GetSessionConnectionInfo(const SteamNetworkingIdentity &identityRemote,
+                                                                     SteamNetConnectionInfo_t *connectionInfo,
+                                                                     SteamNetConnectionRealTimeStatus_t *status) = 0;
+
+    virtual bool SendP2PPacket(CSteamID steamIdRemote, const void *data, uint32 size, EP2PSend sendType) = 0;
+    virtual bool IsP2PPacketAvailable(uint32 *messageSize) = 0;
+    virtual bool ReadP2PPacket(void *dest, uint32 destSize, uint32 *messageSize, CSteamID *steamIdRemote) = 0;
+    virtual bool AcceptP2PSessionWithUser(CSteamID steamIdRemote) = 0;
+    virtual bool CloseP2PSessionWithUser(CSteamID steamIdRemote) = 0;
+    virtual bool GetP2PSessionState(CSteamID steamIdRemote, P2PSessionState_t *sessionState) = 0;
+
+    // Same clock as SteamNetworkingMessage_t::m_usecTimeReceived.
+    virtual SteamNetworkingMicroseconds GetLocalTimestamp() = 0;
+};
+
+class SteamNetworkingTransport : public NetworkingTransport
+{
+  public:
+    EResult SendMessageToUser(const SteamNetworkingIdentity &identityRemote, const void *data, uint32 size,
+                              int sendFlags, int channel) override;
+    int ReceiveMessagesOnChannel(int channel, SteamNetworkingMessage_t **messages, int maxMessages) override;
+    bool AcceptSessionWithUser(const SteamNetworkingIdentity &identityRemote) override;
+    bool CloseSessionWithUser(const SteamNetworkingIdentity &identityRemote) override;
+    ESteamNetworkingConnectionState GetSessionConnectionInfo(const SteamNetworkingIdentity &identityRemote,
+                                                             SteamNetConnectionInfo_t *connectionInfo,
+                                                             SteamNetConnectionRealTimeStatus_t *status) override;
+
+    bool SendP2PPacket(CSteamID steamIdRemote, const void *data, uint32 size, EP2PSend sendType) override;
+    bool IsP2PPacketAvailable(uint32 *messageSize) override;
+    bool ReadP2PPacket(void *dest, uint32 destSize, uint32 *messageSize, CSteamID *steamIdRemote) override;
+    bool AcceptP2PSessionWithUser(CSteamID steamIdRemote) override;
+    bool CloseP2PSessionWithUser(CSteamID steamIdRemote) override;
+    bool GetP2PSessionState(CSteamID steamIdRemote, P2PSessionState_t *sessionState) override;
+
+    SteamNetworkingMicroseconds GetLocalTimestamp() override;
+};
+
+// A transport stacked in front of the active one, e.g. to observe or inject traffic. Forwards
+// everything to the transport below it unless overridden.
+class NetworkingTransportLayer : public NetworkingTransport
+{
+  public:
+    NetworkingTransportLayer() : inner_(nullptr)
+    {
+    }
+
+    void SetInner(NetworkingTransport *inner)
+    {
+        inner_ = inner;
+    }
+
+    EResult SendMessageToUser(const SteamNetworkingIdentity &identityRemote, const void *data, uint32 size,
+                              int sendFlags, int channel) override;
+    int ReceiveMessagesOnChannel(int channel, SteamNetworkingMessage_t **messages, int maxMessages) override;
+    bool AcceptSessionWithUser(const SteamNetworkingIdentity &identityRemote) override;
+    bool CloseSessionWithUser(const SteamNetworkingIdentity &identityRemote) override;
+    ESteamNetworkingConnectionState GetSessionConnectionInfo(const SteamNetworkingIdentity &identityRemote,
+                                                             SteamNetConnectionInfo_t *connectionInfo,
+                                                             SteamNetConnectionRealTimeStatus_t *status) override;
+
+    bool SendP2PPacket(CSteamID steamIdRemote, const void *data, uint32 size, EP2PSend sendType) override;
+    bool IsP2PPacketAvailable(uint32 *messageSize) override;
+    bool ReadP2PPacket(void *dest, uint32 destSize, uint32 *messageSize, CSteamID *steamIdRemote) override;
+    bool AcceptP2PSessionWithUser(CSteamID steamIdRemote) override;
+    bool CloseP2PSessionWithUser(CSteamID steamIdRemote) override;
+    bool GetP2PSessionState(CSteamID steamIdRemote, P2PSessionState_t *sessionState) override;
+
+    SteamNetworkingMicroseconds GetLocalTimestamp() override;
+
+  protected:
+    NetworkingTransport *inner_;
+};
+
+// The transport used by the networking bindings: the layer if one is set, otherwise the base
+// transport, behind the activity observer when one is set. Defaults to Steam.
+NetworkingTransport *GetNetworkingTransport();
+
+// Replaces the base transport, keeping any layer on top of it. Passing nullptr restores Steam.
+void SetNetworkingTransport(NetworkingTransport *transport);
+
+// Passing nullptr removes the layer.
+void SetNetworkingTransportLayer(NetworkingTransportLayer *layer);
+NetworkingTransportLayer *GetNetworkingTransportLayer();
+
+// Called with the peer and channel of every message sent or received through
+// GetNetworkingTransport(), on any channel and through any layer. Legacy P2P packets report channel
+// -1. Passing nullptr stops the reports.
+typedef void (*NetworkingActivityObserver)(uint64 peer, int channel);
+void SetNetworkingActivityObserver(NetworkingActivityObserver observer);
+
+#endif // SRC_GREENWORKS_NETWORKING_TRANSPORT_H_
@@ -0,0 +1,522 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "greenworks_packet_capture.h"
+
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+// File layout: magic, offset of the end of the last complete record, then records back to back.
+// The end offset is rewritten after every record so a capture cut short by a crash stays readable.
+const char kCaptureMagic[8] = {'G', 'W', 'C', 'A', 'P', '0', '1', '\0'};
+const uint64 kCaptureHeaderSize = 16;
+
+// timestamp, peer, message number, channel, flags, size, direction and 3 bytes of padding.
+const uint64 kRecordHeaderSize = 40;
+
+const uint64 kInitialCaptureSize = 1 << 20;
+
+const int kP2PChannel = -1;
+
+// The SDK keeps the message destructor protected; a derived type can be created and deleted here.
+struct ReplayMessage : public SteamNetworkingMessage_t
+{
+};
+
+void ReleaseReplayMessage(SteamNetworkingMessage_t *message)
+{
+    ReplayMessage *replayMessage = static_cast<ReplayMessage *>(message);
+    delete[] static_cast<uint8 *>(replayMessage->m_pData);
+    delete replayMessage;
+}
+
+} // namespace
+
+MappedFile::MappedFile()
+    : data_(nullptr), size_(0), writable_(false),
+#if defined(_WIN32)
+      file_(INVALID_HANDLE_VALUE), mapping_(nullptr)
+#else
+      fd_(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close(size_);
+}
+
+bool MappedFile::Create(const std::string &path, uint64 size)
+{
+    Close(size_);
+    writable_ = true;
+    size_ = size;
+#if defined(_WIN32)
+    file_ = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE)
+        return false;
+#else
+    fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0)
+        return false;
+    if (ftruncate(fd_, static_cast<off_t>(size)) != 0)
+    {
+        Close(0);
+        return false;
+    }
+#endif
+    if (!Map())
+    {
+        Close(0);
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::OpenReadOnly(const std::string &path)
+{
+    Close(size_);
+    writable_ = false;
+#if defined(_WIN32)
+    file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file_, &fileSize))
+    {
+        Close(0);
+        return false;
+    }
+    size_ = static_cast<uint64>(fileSize.QuadPart);
+#else
+    fd_ = open(path.c_str(), O_RDONLY);
+    if (fd_ < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd_, &st) != 0)
+    {
+        Close(0);
+        return false;
+    }
+    size_ = static_cast<uint64>(st.st_size);
+#endif
+    if (size_ == 0 || !Map())
+    {
+        Close(0);
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::Resize(uint64 size)
+{
+    Unmap();
+    size_ = size;
+#if !defined(_WIN32)
+    // On Windows creating the larger mapping grows the file.
+    if (ftruncate(fd_, static_cast<off_t>(size)) != 0)
+        return false;
+#endif
+    return Map();
+}
+
+void MappedFile::Close(uint64 size)
+{
+    Unmap();
+#if defined(_WIN32)
+    if (file_ != INVALID_HANDLE_VALUE)
+    {
+        if (writable_)
+        {
+            LARGE_INTEGER end;
+            end.QuadPart = static_cast<LONGLONG>(size);
+            SetFilePointerEx(file_, end, nullptr, FILE_BEGIN);
+            SetEndOfFile(file_);
+        }
+        CloseHandle(file_);
+        file_ = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (fd_ >= 0)
+    {
+        if (writable_ && ftruncate(fd_, static_cast<off_t>(size)) != 0)
+        {
+            // Leaves trailing zeroes; readers stop at the end offset in the header anyway.
+        }
+        close(fd_);
+        fd_ = -1;
+    }
+#endif
+    size_ = 0;
+}
+
+bool MappedFile::Map()
+{
+#if defined(_WIN32)
+    mapping_ = CreateFileMappingA(file_, nullptr, writable_ ? PAGE_READWRITE : PAGE_READONLY,
+                                  static_cast<DWORD>(size_ >> 32), static_cast<DWORD>(size_), nullptr);
+    if (mapping_ == nullptr)
+        return false;
+    data_ = static_cast<uint8 *>(MapViewOfFile(mapping_, writable_ ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+    return data_ != nullptr;
+#else
+    void *data = mmap(nullptr, static_cast<size_t>(size_), writable_ ? PROT_READ | PROT_WRITE : PROT_READ,
+                      writable_ ? MAP_SHARED : MAP_PRIVATE, fd_, 0);
+    if (data == MAP_FAILED)
+        return false;
+    data_ = static_cast<uint8 *>(data);
+    return true;
+#endif
+}
+
+void MappedFile::Unmap()
+{
+#if defined(_WIN32)
+    if (data_ != nullptr)
+        UnmapViewOfFile(data_);
+    if (mapping_ != nullptr)
+    {
+        CloseHandle(mapping_);
+        mapping_ = nullptr;
+    }
+#else
+    if (data_ != nullptr)
+        munmap(data_, static_cast<size_t>(size_));
+#endif
+    data_ = nullptr;
+}
+
+CaptureWriter::CaptureWriter() : end_(0), records_(0), open_(false)
+{
+}
+
+CaptureWriter::~CaptureWriter()
+{
+    Close();
+}
+
+bool CaptureWriter::Open(const std::string &path)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (open_ || !file_.Create(path, kInitialCaptureSize))
+        return false;
+
+    end_ = kCaptureHeaderSize;
+    records_ = 0;
+    memcpy(file_.Data(), kCaptureMagic, sizeof(kCaptureMagic));
+    memcpy(file_.Data() + 8, &end_, sizeof(end_));
+    open_ = true;
+    return true;
+}
+
+void CaptureWriter::Append(const CaptureRecord &record)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!open_)
+        return;
+
+    uint64 needed = end_ + kRecordHeaderSize + record.size;
+    if (needed > file_.Size())
+    {
+        uint64 size = file_.Size() * 2;
+        while (size < needed)
+            size *= 2;
+        if (!file_.Resize(size))
+        {
+            // Keep what was captured so far rather than crash mid-session.
+            file_.Close(end_);
+            open_ = false;
+            return;
+        }
+    }
+
+    uint8 *out = file_.Data() + end_;
+    uint8 padding[3] = {0, 0, 0};
+    memcpy(out, &record.timestamp, 8);
+    memcpy(out + 8, &record.peer, 8);
+    memcpy(out + 16, &record.message_number, 8);
+    memcpy(out + 24, &record.channel, 4);
+    memcpy(out + 28, &record.flags, 4);
+    memcpy(out + 32, &record.size, 4);
+    out[36] = record.direction;
+    memcpy(out + 37, padding, sizeof(padding));
+    if (record.size > 0)
+        memcpy(out + kRecordHeaderSize, record.data, record.size);
+
+    end_ = needed;
+    memcpy(file_.Data() + 8, &end_, sizeof(end_));
+    ++records_;
+}
+
+void CaptureWriter::Close()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!open_)
+        return;
+    file_.Close(end_);
+    open_ = false;
+}
+
+uint64 CaptureWriter::GetRecordCount()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return records_;
+}
+
+uint64 CaptureWriter::GetByteCount()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return end_;
+}
+
+bool CaptureReader::Open(const std::string &path)
+{
+    if (!file_.OpenReadOnly(path))
+        return false;
+
+    if (file_.Size() < kCaptureHeaderSize || memcmp(file_.Data(), kCaptureMagic, sizeof(kCaptureMagic)) != 0)
+    {
+        file_.Close(0);
+        return false;
+    }
+
+    memcpy(&end_, file_.Data() + 8, sizeof(end_));
+    if (end_ < kCaptureHeaderSize || end_ > file_.Size())
+        end_ = file_.Size();
+    offset_ = kCaptureHeaderSize;
+    return true;
+}
+
+bool CaptureReader::Next(CaptureRecord *record)
+{
+    if (end_ - offset_ < kRecordHeaderSize)
+        return false;
+
+    const uint8 *in = file_.Data() + offset_;
+    memcpy(&record->timestamp, in, 8);
+    memcpy(&record->peer, in + 8, 8);
+    memcpy(&record->message_number, in + 16, 8);
+    memcpy(&record->channel, in + 24, 4);
+    memcpy(&record->flags, in + 28, 4);
+    memcpy(&record->size, in + 32, 4);
+    record->direction = in[36];
+    record->data = in + kRecordHeaderSize;
+
+    if (end_ - offset_ - kRecordHeaderSize < record->size)
+        return false;
+
+    offset_ += kRecordHeaderSize + record->size;
+    return true;
+}
+
+void CaptureReader::Rewind()
+{
+    offset_ = kCaptureHeaderSize;
+}
+
+CaptureTransport::CaptureTransport(CaptureWriter *writer) : writer_(writer)
+{
+}
+
+EResult CaptureTransport::SendMessageToUser(const SteamNetworkingIdentity &identityRemote, const void *data,
+                                            uint32 size, int sendFlags, int channel)
+{
+    EResult result = inner_->SendMessageToUser(identityRemote, data, size, sendFlags, channel);
+    if (result == k_EResultOK)
+        Record(kCaptureOutbound, inner_->GetLocalTimestamp(), identityRemote.GetSteamID64(), 0, channel, sendFlags,
+               data, size);
+    return result;
+}
+
+int CaptureTransport::ReceiveMessagesOnChannel(int channel, SteamNetworkingMessage_t **messages, int maxMessages)
+{
+    int messageCount = inner_->ReceiveMessagesOnChannel(channel, messages, maxMessages);
+    for (int i = 0; i < messageCount; i++)
+    {
+        SteamNetworkingMessage_t *message = messages[i];
+        // Stamped with the arrival time, not the poll time, so replay reproduces the network's timing.
+        Record(kCaptureInbound, message->m_usecTimeReceived, message->m_identityPeer.GetSteamID64(),
+               message->m_nMessageNumber, channel, message->m_nFlags, message->GetData(),
+               static_cast<uint32>(message->m_cbSize));
+    }
+    return messageCount;
+}
+
+bool CaptureTransport::SendP2PPacket(CSteamID steamIdRemote, const void *data, uint32 size, EP2PSend sendType)
+{
+    bool sent = inner_->SendP2PPacket(steamIdRemote, data, size, sendType);
+    if (sent)
+        Record(kCaptureOutbound, inner_->GetLocalTimestamp(), steamIdRemote.ConvertToUint64(), 0, kP2PChannel,
+               sendType, data, size);
+    return sent;
+}
+
+bool CaptureTransport::ReadP2PPacket(void *dest, uint32 destSize, uint32 *messageSize, CSteamID *steamIdRemote)
+{
+    bool success = inner_->ReadP2PPacket(dest, destSize, messageSize, steamIdRemote);
+    if (success)
+    {
+        // The P2P API gives no arrival time.
+        Record(kCaptureInbound, inner_->GetLocalTimestamp(), steamIdRemote->ConvertToUint64(), 0, kP2PChannel, 0,
+               dest, *messageSize < destSize ? *messageSize : destSize);
+    }
+    return success;
+}
+
+void CaptureTransport::Record(uint8 direction, SteamNetworkingMicroseconds timestamp, uint64 peer,
+                              int64 messageNumber, int channel, int flags, const void *data, uint32 size)
+{
+    CaptureRecord record;
+    record.timestamp = timestamp;
+    record.peer = peer;
+    record.message_number = messageNumber;
+    record.channel = channel;
+    record.flags = flags;
+    record.size = size;
+    record.direction = direction;
+    record.data = static_cast<const uint8 *>(data);
+    writer_->Append(record);
+}
+
+ReplayTransport::ReplayTransport(CaptureReader *reader, double speed)
+    : reader_(reader), speed_(speed), started_(false), exhausted_(false), start_time_(0), first_timestamp_(0),
+      has_next_(false), replayed_(0)
+{
+    // Times are relative to the first record in either direction, so leading outbound traffic
+    // keeps its gap in front of the first inbound message.
+    reader_->Rewind();
+    CaptureRecord first;
+    if (reader_->Next(&first))
+        first_timestamp_ = first.timestamp;
+    reader_->Rewind();
+}
+
+ReplayTransport::~ReplayTransport()
+{
+    for (auto &ready : ready_)
+    {
+        for (SteamNetworkingMessage_t *message : ready.second)
+            message->Release();
+    }
+}
+
+void ReplayTransport::Advance()
+{
+    SteamNetworkingMicroseconds now = inner_->GetLocalTimestamp();
+    if (!started_)
+    {
+        started_ = true;
+        start_time_ = now;
+    }
+
+    while (!exhausted_)
+    {
+        if (!has_next_)
+        {
+            while ((has_next_ = reader_->Next(&next_)) && next_.direction != kCaptureInbound)
+            {
+            }
+            if (!has_next_)
+            {
+                exhausted_ = true;
+                break;
+            }
+        }
+
+        if (speed_ > 0 && (next_.timestamp - first_timestamp_) / speed_ > now - start_time_)
+            break;
+
+        ReplayMessage *message = new ReplayMessage();
+        message->m_pData = new uint8[next_.size > 0 ? next_.size : 1];
+        memcpy(message->m_pData, next_.data, next_.size);
+        message->m_cbSize = static_cast<int>(next_.size);
+        message->m_identityPeer.SetSteamID64(next_.peer);
+        message->m_usecTimeReceived = now;
+        message->m_nMessageNumber = next_.message_number;
+        message->m_pfnRelease = ReleaseReplayMessage;
+        message->m_nChannel = next_.channel;
+        message->m_nFlags = next_.flags;
+        ready_[next_.channel].push_back(message);
+
+        has_next_ = false;
+        ++replayed_;
+    }
+}
+
+int ReplayTransport::ReceiveMessagesOnChannel(int channel, SteamNetworkingMessage_t **messages, int maxMessages)
+{
+    Advance();
+
+    int messageCount = 0;
+    std::deque<SteamNetworkingMessage_t *> &ready = ready_[channel];
+    while (messageCount < maxMessages && !ready.empty())
+    {
+        messages[messageCount++] = ready.front();
+        ready.pop_front();
+    }
+
+    if (messageCount < maxMessages)
+    {
+        int live = inner_->ReceiveMessagesOnChannel(channel, messages + messageCount, maxMessages - messageCount);
+        if (live > 0)
+            messageCount += live;
+    }
+
+    return messageCount;
+}
+
+bool ReplayTransport::IsP2PPacketAvailable(uint32 *messageSize)
+{
+    Advance();
+
+    std::deque<SteamNetworkingMessage_t *> &ready = ready_[kP2PChannel];
+    if (ready.empty())
+        return inner_->IsP2PPacketAvailable(messageSize);
+
+    *messageSize = static_cast<uint32>(ready.front()->m_cbSize);
+    return true;
+}
+
+bool ReplayTransport::ReadP2PPacket(void *dest, uint32 destSize, uint32 *messageSize, CSteamID *steamIdRemote)
+{
+    Advance();
+
+    std::deque<SteamNetworkingMessage_t *> &ready = ready_[kP2PChannel];
+    if (ready.empty())
+        return inner_->ReadP2PPacket(dest, destSize, messageSize, steamIdRemote);
+
+    SteamNetworkingMessage_t *message = ready.front();
+    ready.pop_front();
+
+    uint32 size = static_cast<uint32>(message->m_cbSize);
+    memcpy(dest, message->GetData(), size < destSize ? size : destSize);
+    *messageSize = size;
+    *steamIdRemote = CSteamID(message->m_identityPeer.GetSteamID64());
+    message->Release();
+    return true;
+}
+
+bool ReplayTransport::IsFinished() const
+{
+    if (!exhausted_ || has_next_)
+        return false;
+    for (const auto &ready : ready_)
+    {
+        if (!ready.second.empty())
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,169 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SRC_GREENWORKS_PACKET_CAPTURE_H_
+#define SRC_GREENWORKS_PACKET_CAPTURE_H_
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "greenworks_networking_transport.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+enum CaptureDirection
+{
+    kCaptureInbound = 0,
+    kCaptureOutbound = 1,
+};
+
+// One message as stored in a capture file. Legacy P2P packets use channel -1 and store the
+// EP2PSend type in |flags|.
+struct CaptureRecord
+{
+    // Send time for outbound records, arrival time for inbound ones.
+    SteamNetworkingMicroseconds timestamp;
+    uint64 peer;
+    int64 message_number;
+    int32 channel;
+    int32 flags;
+    uint32 size;
+    uint8 direction;
+    const uint8 *data;
+};
+
+// A file mapped into memory, either growing for writing or whole and read-only.
+class MappedFile
+{
+  public:
+    MappedFile();
+    ~MappedFile();
+
+    bool Create(const std::string &path, uint64 size);
+    bool OpenReadOnly(const std::string &path);
+    // Remaps a writable file with a new size. The old mapping is invalidated.
+    bool Resize(uint64 size);
+    // Unmaps, truncating a writable file to |size| bytes.
+    void Close(uint64 size);
+
+    uint8 *Data() const
+    {
+        return data_;
+    }
+    uint64 Size() const
+    {
+        return size_;
+    }
+
+  private:
+    bool Map();
+    void Unmap();
+
+    uint8 *data_;
+    uint64 size_;
+    bool writable_;
+#if defined(_WIN32)
+    HANDLE file_;
+    HANDLE mapping_;
+#else
+    int fd_;
+#endif
+};
+
+// Appends records to a capture file. Thread safe.
+class CaptureWriter
+{
+  public:
+    CaptureWriter();
+    ~CaptureWriter();
+
+    bool Open(const std::string &path);
+    void Append(const CaptureRecord &record);
+    void Close();
+
+    uint64 GetRecordCount();
+    uint64 GetByteCount();
+
+  private:
+    std::mutex mutex_;
+    MappedFile file_;
+    uint64 end_;
+    uint64 records_;
+    bool open_;
+};
+
+// Walks the records of a capture file in the order they were written.
+class CaptureReader
+{
+  public:
+    bool Open(const std::string &path);
+    // |record->data| points into the mapping and stays valid while the reader is open.
+    bool Next(CaptureRecord *record);
+    void Rewind();
+
+  private:
+    MappedFile file_;
+    uint64 end_;
+    uint64 offset_;
+};
+
+// Records everything sent and received through the transport below it.
+class CaptureTransport : public NetworkingTransportLayer
+{
+  public:
+    explicit CaptureTransport(CaptureWriter *writer);
+
+    EResult SendMessageToUser(const SteamNetworkingIdentity &identityRemote, const void *data, uint32 size,
+                              int sendFlags, int channel) override;
+    int ReceiveMessagesOnChannel(int channel, SteamNetworkingMessage_t **messages, int maxMessages) override;
+    bool SendP2PPacket(CSteamID steamIdRemote, const void *data, uint32 size, EP2PSend sendType) override;
+    bool ReadP2PPacket(void *dest, uint32 destSize, uint32 *messageSize, CSteamID *steamIdRemote) override;
+
+  private:
+    void Record(uint8 direction, SteamNetworkingMicroseconds timestamp, uint64 peer, int64 messageNumber,
+                int channel, int flags, const void *data, uint32 size);
+
+    CaptureWriter *writer_;
+};
+
+// Feeds the inbound records of a capture into the receive path, ahead of any live traffic from
+// the transport below. Outbound records are skipped. A speed of 1 keeps the recorded timing,
+// higher values compress it and 0 releases everything at once.
+class ReplayTransport : public NetworkingTransportLayer
+{
+  public:
+    ReplayTransport(CaptureReader *reader, double speed);
+    ~ReplayTransport();
+
+    int ReceiveMessagesOnChannel(int channel, SteamNetworkingMessage_t **messages, int maxMessages) override;
+    bool IsP2PPacketAvailable(uint32 *messageSize) override;
+    bool ReadP2PPacket(void *dest, uint32 destSize, uint32 *messageSize, CSteamID *steamIdRemote) override;
+
+    // True once every record has been handed out.
+    bool IsFinished() const;
+    uint64 GetReplayedCount() const
+    {
+        return replayed_;
+    }
+
+  private:
+    void Advance();
+
+    CaptureReader *reader_;
+    double speed_;
+    bool started_;
+    bool exhausted_;
+    SteamNetworkingMicroseconds start_time_;
+    SteamNetworkingMicroseconds first_timestamp_;
+    bool has_next_;
+    CaptureRecord next_;
+    uint64 replayed_;
+    std::map<int, std::deque<SteamNetworkingMessage_t *>> ready_;
+};
+
+#endif // SRC_GREENWORKS_PACKET_CAPTURE_H_
@@ -0,0 +1,119 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "greenworks_rate_controller.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+
+const double kInitialRate = 256 * 1024;
+const double kMinRate = 16 * 1024;
+// Growth of the rate per second without congestion: 16KB per tick at the default 50ms tick.
+const double kAdditiveIncreasePerSecond = 320 * 1024;
+// Longer gaps between samples, e.g. after a stall, do not earn a bigger step.
+const SteamNetworkingMicroseconds kMaxIncreaseInterval = 100 * 1000;
+const double kMultiplicativeDecrease = 0.7;
+
+// Steam's send queue is kept at about this much time worth of data.
+const SteamNetworkingMicroseconds kTargetQueueTime = 50 * 1000;
+
+// Below this local connection quality (1 - loss) the link counts as congested.
+const float kMinQuality = 0.95f;
+
+} // namespace
+
+void SendRateController::Track(uint64 peer)
+{
+    if (peers_.find(peer) != peers_.end())
+        return;
+
+    PeerState &state = peers_[peer];
+    state.has_sample = false;
+    state.rate = kInitialRate;
+    state.last_decrease = 0;
+    state.last_update = 0;
+    memset(&state.status, 0, sizeof(state.status));
+}
+
+void SendRateController::Untrack(uint64 peer)
+{
+    peers_.erase(peer);
+}
+
+std::vector<uint64> SendRateController::GetTrackedPeers() const
+{
+    std::vector<uint64> peers;
+    peers.reserve(peers_.size());
+    for (const auto &peer : peers_)
+        peers.push_back(peer.first);
+    return peers;
+}
+
+void SendRateController::Update(uint64 peer, const SteamNetConnectionRealTimeStatus_t &status,
+                                SteamNetworkingMicroseconds now)
+{
+    auto found = peers_.find(peer);
+    if (found == peers_.end() || status.m_eState != k_ESteamNetworkingConnectionState_Connected)
+        return;
+
+    PeerState &state = found->second;
+    state.status = status;
+
+    // Never ask for more than Steam is currently willing to put on the wire.
+    double ceiling = std::max(kMinRate, static_cast<double>(status.m_nSendRateBytesPerSecond));
+    if (!state.has_sample)
+    {
+        state.has_sample = true;
+        state.rate = std::min(kInitialRate, ceiling);
+        state.last_update = now;
+        return;
+    }
+
+    SteamNetworkingMicroseconds elapsed = std::min(std::max<SteamNetworkingMicroseconds>(now - state.last_update, 0),
+                                                   kMaxIncreaseInterval);
+    state.last_update = now;
+
+    int pending = status.m_cbPendingReliable + status.m_cbPendingUnreliable;
+    bool congested = status.m_usecQueueTime > kTargetQueueTime ||
+                     pending > state.rate * kTargetQueueTime / 1000000 ||
+                     (status.m_flConnectionQualityLocal >= 0 && status.m_flConnectionQualityLocal < kMinQuality);
+
+    if (congested)
+    {
+        // Back off at most once per round trip so a single burst is not punished repeatedly.
+        SteamNetworkingMicroseconds rtt = static_cast<SteamNetworkingMicroseconds>(std::max(status.m_nPing, 1)) * 1000;
+        if (now - state.last_decrease >= rtt)
+        {
+            state.rate = std::max(kMinRate, state.rate * kMultiplicativeDecrease);
+            state.last_decrease = now;
+        }
+    }
+    else
+    {
+        state.rate = std::min(ceiling, state.rate + kAdditiveIncreasePerSecond * elapsed / 1000000);
+    }
+}
+
+bool SendRateController::GetRate(uint64 peer, int tick_ms, PeerRate *rate) const
+{
+    auto found = peers_.find(peer);
+    if (found == peers_.end())
+        return false;
+
+    const PeerState &state = found->second;
+    int pending = state.status.m_cbPendingReliable + state.status.m_cbPendingUnreliable;
+    double allowed = state.rate * (tick_ms * 1000 + kTargetQueueTime) / 1000000;
+
+    rate->peer = peer;
+    rate->rate = static_cast<int>(state.rate);
+    rate->budget = static_cast<int>(std::max(0.0, allowed - pending));
+    rate->ping = state.status.m_nPing;
+    rate->quality = state.status.m_flConnectionQualityLocal;
+    rate->pending_bytes = pending;
+    rate->queue_time = state.status.m_usecQueueTime;
+    return true;
+}
@@ -0,0 +1,54 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SRC_GREENWORKS_RATE_CONTROLLER_H_
+#define SRC_GREENWORKS_RATE_CONTROLLER_H_
+
+#include <map>
+#include <vector>
+
+#include "steam/steamnetworkingtypes.h"
+
+// Additive-increase/multiplicative-decrease estimate of how fast each peer can be fed, from the
+// real-time status Steam keeps per session. Steam only takes send rates globally, so the result is
+// handed to JS as a payload budget per tick rather than applied to the connection.
+class SendRateController
+{
+  public:
+    struct PeerRate
+    {
+        uint64 peer;
+        int rate;
+        int budget;
+        int ping;
+        float quality;
+        int pending_bytes;
+        SteamNetworkingMicroseconds queue_time;
+    };
+
+    void Track(uint64 peer);
+    void Untrack(uint64 peer);
+    std::vector<uint64> GetTrackedPeers() const;
+
+    // Feeds one status sample. Ignored for untracked peers and sessions that are not connected.
+    void Update(uint64 peer, const SteamNetConnectionRealTimeStatus_t &status, SteamNetworkingMicroseconds now);
+
+    // Bytes that can be queued for |peer| during the next |tick_ms| without growing Steam's queue
+    // past the target. Returns false for untracked peers.
+    bool GetRate(uint64 peer, int tick_ms, PeerRate *rate) const;
+
+  private:
+    struct PeerState
+    {
+        bool has_sample;
+        double rate;
+        SteamNetworkingMicroseconds last_decrease;
+        SteamNetworkingMicroseconds last_update;
+        SteamNetConnectionRealTimeStatus_t status;
+    };
+
+    std::map<uint64, PeerState> peers_;
+};
+
+#endif // SRC_GREENWORKS_RATE_CONTROLLER_H_
@@ -0,0 +1,169 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "greenworks_reliable_stream.h"
+
+#include <climits>
+
+namespace
+{
+
+const uint32 kDefaultHighWaterMark = 1024 * 1024;
+// Well under the 16MB send buffer set in Initialize.
+const uint32 kDefaultSendWindow = 4 * 1024 * 1024;
+
+} // namespace
+
+ReliableStreams::ReliableStreams() : high_water_mark_(kDefaultHighWaterMark), send_window_(kDefaultSendWindow)
+{
+}
+
+void ReliableStreams::SetOptions(uint32 high_water_mark, uint32 send_window)
+{
+    high_water_mark_ = high_water_mark;
+    send_window_ = send_window;
+}
+
+bool ReliableStreams::Write(uint64 peer, int channel, const uint8 *data, uint32 size)
+{
+    auto found = streams_.find(std::make_pair(peer, channel));
+    if (found == streams_.end())
+    {
+        Stream stream;
+        stream.queued_bytes = 0;
+        stream.sent_bytes = 0;
+        stream.failed_messages = 0;
+        stream.last_result = k_EResultOK;
+        stream.needs_drain = false;
+        found = streams_.insert(std::make_pair(std::make_pair(peer, channel), stream)).first;
+    }
+
+    Stream &stream = found->second;
+    stream.queue.push_back(std::vector<uint8>(data, data + size));
+    stream.queued_bytes += size;
+
+    Pump(peer);
+
+    if (IsWritable(stream, peers_[peer]))
+        return true;
+
+    stream.needs_drain = true;
+    return false;
+}
+
+void ReliableStreams::Tick(std::vector<StreamId> *drained)
+{
+    for (auto &peer : peers_)
+        Pump(peer.first);
+
+    for (auto &stream : streams_)
+    {
+        if (!stream.second.needs_drain)
+            continue;
+
+        const PeerState &peer = peers_[stream.first.first];
+        if (stream.second.queued_bytes + peer.pending_reliable_bytes < high_water_mark_ / 2)
+        {
+            stream.second.needs_drain = false;
+            drained->push_back(stream.first);
+        }
+    }
+}
+
+bool ReliableStreams::GetStatus(uint64 peer, int channel, Status *status) const
+{
+    auto found = streams_.find(std::make_pair(peer, channel));
+    if (found == streams_.end())
+        return false;
+
+    const Stream &stream = found->second;
+    const PeerState &state = peers_.find(peer)->second;
+    status->queued_bytes = stream.queued_bytes;
+    status->queued_messages = static_cast<uint32>(stream.queue.size());
+    status->pending_reliable_bytes = state.pending_reliable_bytes;
+    status->pending_unreliable_bytes = state.pending_unreliable_bytes;
+    status->writable = IsWritable(stream, state);
+    status->sent_bytes = stream.sent_bytes;
+    status->failed_messages = stream.failed_messages;
+    status->last_result = stream.last_result;
+    return true;
+}
+
+void ReliableStreams::Remove(uint64 peer)
+{
+    auto stream = streams_.lower_bound(std::make_pair(peer, INT_MIN));
+    while (stream != streams_.end() && stream->first.first == peer)
+        stream = streams_.erase(stream);
+    peers_.erase(peer);
+}
+
+void ReliableStreams::Pump(uint64 peer)
+{
+    NetworkingTransport *transport = GetNetworkingTransport();
+
+    SteamNetworkingIdentity identity;
+    identity.SetSteamID64(peer);
+
+    SteamNetConnectionRealTimeStatus_t realTimeStatus;
+    PeerState &state = peers_[peer];
+    if (transport->GetSessionConnectionInfo(identity, nullptr, &realTimeStatus) !=
+        k_ESteamNetworkingConnectionState_None)
+    {
+        state.pending_reliable_bytes = realTimeStatus.m_cbPendingReliable;
+        state.pending_unreliable_bytes = realTimeStatus.m_cbPendingUnreliable;
+    }
+    else
+    {
+        state.pending_reliable_bytes = 0;
+        state.pending_unreliable_bytes = 0;
+    }
+
+    auto first = streams_.lower_bound(std::make_pair(peer, INT_MIN));
+
+    // One message per stream per pass so channels to the same peer share the window.
+    bool sent = true;
+    while (sent)
+    {
+        sent = false;
+        for (auto stream = first; stream != streams_.end() && stream->first.first == peer; ++stream)
+        {
+            if (stream->second.queue.empty())
+                continue;
+
+            const std::vector<uint8> &message = stream->second.queue.front();
+            uint32 size = static_cast<uint32>(message.size());
+            // An empty window always takes one message, however large, so nothing is stuck forever.
+            if (state.pending_reliable_bytes > 0 &&
+                static_cast<uint64>(state.pending_reliable_bytes) + size > send_window_)
+                return;
+
+            EResult result = transport->SendMessageToUser(
+                identity, message.data(), size,
+                k_nSteamNetworkingSend_Reliable | k_nSteamNetworkingSend_AutoRestartBrokenSession,
+                stream->first.second);
+            stream->second.last_result = result;
+            if (result == k_EResultLimitExceeded)
+                return;
+
+            if (result == k_EResultOK)
+            {
+                stream->second.sent_bytes += size;
+                state.pending_reliable_bytes += size;
+            }
+            else
+            {
+                ++stream->second.failed_messages;
+            }
+
+            stream->second.queued_bytes -= size;
+            stream->second.queue.pop_front();
+            sent = true;
+        }
+    }
+}
+
+bool ReliableStreams::IsWritable(const Stream &stream, const PeerState &peer) const
+{
+    return stream.queued_bytes + peer.pending_reliable_bytes < high_water_mark_;
+}
@@ -0,0 +1,83 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SRC_GREENWORKS_RELIABLE_STREAM_H_
+#define SRC_GREENWORKS_RELIABLE_STREAM_H_
+
+#include <deque>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "greenworks_networking_transport.h"
+
+// Flow-controlled reliable streams, one per peer and channel.
+//
+// Writes are queued natively and handed to Steam only while the session's pending reliable bytes
+// stay under the send window, so the Steam send buffer never fills and k_EResultLimitExceeded is
+// not hit. Like a Node writable stream, Write() returns false once the stream's queued bytes plus
+// the session's pending reliable bytes reach the high water mark; the stream is reported drained by
+// Tick() when they fall back under half of it.
+class ReliableStreams
+{
+  public:
+    typedef std::pair<uint64, int> StreamId;
+
+    struct Status
+    {
+        uint64 queued_bytes;
+        uint32 queued_messages;
+        // Per session, shared by every channel to the peer.
+        int pending_reliable_bytes;
+        int pending_unreliable_bytes;
+        bool writable;
+        uint64 sent_bytes;
+        uint64 failed_messages;
+        EResult last_result;
+    };
+
+    ReliableStreams();
+
+    void SetOptions(uint32 high_water_mark, uint32 send_window);
+
+    // Copies |data| into the stream's queue and sends what the window allows. Returns false when the
+    // producer should wait for the stream to drain.
+    bool Write(uint64 peer, int channel, const uint8 *data, uint32 size);
+
+    // Sends queued messages as the window opens. Streams that went from full to drained are appended
+    // to |drained|.
+    void Tick(std::vector<StreamId> *drained);
+
+    bool GetStatus(uint64 peer, int channel, Status *status) const;
+
+    // Drops every stream to |peer|, including the messages still queued.
+    void Remove(uint64 peer);
+
+  private:
+    struct Stream
+    {
+        std::deque<std::vector<uint8>> queue;
+        uint64 queued_bytes;
+        uint64 sent_bytes;
+        uint64 failed_messages;
+        EResult last_result;
+        bool needs_drain;
+    };
+
+    struct PeerState
+    {
+        int pending_reliable_bytes;
+        int pending_unreliable_bytes;
+    };
+
+    void Pump(uint64 peer);
+    bool IsWritable(const Stream &stream, const PeerState &peer) const;
+
+    uint32 high_water_mark_;
+    uint32 send_window_;
+    std::map<StreamId, Stream> streams_;
+    std::map<uint64, PeerState> peers_;
+};
+
+#endif // SRC_GREENWORKS_RELIABLE_STREAM_H_
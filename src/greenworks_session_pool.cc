@@ -0,0 +1,132 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "greenworks_session_pool.h"
+
+namespace
+{
+
+const int kDefaultKeepaliveMs = 5000;
+const int kDefaultIdleTimeoutMs = 60000;
+
+const int kMaxDrainedMessages = 32;
+
+// Keepalives carry no information; the receiving pool drops them.
+const uint8 kKeepalive = 0;
+
+} // namespace
+
+SessionPool::SessionPool(int channel) : channel_(channel)
+{
+    SetTimeouts(kDefaultKeepaliveMs, kDefaultIdleTimeoutMs);
+}
+
+void SessionPool::SetTimeouts(int keepalive_ms, int idle_timeout_ms)
+{
+    keepalive_us_ = static_cast<SteamNetworkingMicroseconds>(keepalive_ms) * 1000;
+    idle_timeout_us_ = static_cast<SteamNetworkingMicroseconds>(idle_timeout_ms) * 1000;
+}
+
+void SessionPool::Prewarm(uint64 peer)
+{
+    if (peers_.find(peer) != peers_.end())
+        return;
+
+    SteamNetworkingMicroseconds now = GetNetworkingTransport()->GetLocalTimestamp();
+
+    PeerState &state = peers_[peer];
+    state.state = k_ESteamNetworkingConnectionState_None;
+    state.started = now;
+    state.last_activity = now;
+    state.warm_up_ms = -1;
+
+    // The first message is what makes Steam start route discovery and the session handshake.
+    SendKeepalive(peer, &state, now);
+}
+
+void SessionPool::Touch(uint64 peer)
+{
+    auto found = peers_.find(peer);
+    if (found == peers_.end())
+        return;
+
+    SteamNetworkingMicroseconds now = GetNetworkingTransport()->GetLocalTimestamp();
+    found->second.last_activity = now;
+    found->second.last_send = now;
+}
+
+void SessionPool::Remove(uint64 peer)
+{
+    peers_.erase(peer);
+}
+
+void SessionPool::Tick(std::vector<Event> *events)
+{
+    NetworkingTransport *transport = GetNetworkingTransport();
+
+    SteamNetworkingMessage_t *messages[kMaxDrainedMessages];
+    int messageCount;
+    while ((messageCount = transport->ReceiveMessagesOnChannel(channel_, messages, kMaxDrainedMessages)) > 0)
+    {
+        for (int i = 0; i < messageCount; i++)
+            messages[i]->Release();
+    }
+
+    if (peers_.empty())
+        return;
+
+    SteamNetworkingMicroseconds now = transport->GetLocalTimestamp();
+
+    for (auto it = peers_.begin(); it != peers_.end();)
+    {
+        uint64 peer = it->first;
+        PeerState &state = it->second;
+
+        SteamNetworkingIdentity identity;
+        identity.SetSteamID64(peer);
+
+        if (idle_timeout_us_ > 0 && now - state.last_activity > idle_timeout_us_)
+        {
+            transport->CloseSessionWithUser(identity);
+            events->push_back({kSessionIdleClosed, peer, k_ESteamNetworkingConnectionState_None, state.warm_up_ms});
+            it = peers_.erase(it);
+            continue;
+        }
+
+        ESteamNetworkingConnectionState current = transport->GetSessionConnectionInfo(identity, nullptr, nullptr);
+        if (current != state.state)
+        {
+            state.state = current;
+            if (current == k_ESteamNetworkingConnectionState_Connected && state.warm_up_ms < 0)
+                state.warm_up_ms = (now - state.started) / 1000;
+            events->push_back({kSessionStateChanged, peer, current, state.warm_up_ms});
+        }
+
+        // Broken sessions are restarted by the keepalive itself.
+        if (keepalive_us_ > 0 && now - state.last_send > keepalive_us_)
+            SendKeepalive(peer, &state, now);
+
+        ++it;
+    }
+}
+
+std::vector<SessionPool::PeerStatus> SessionPool::GetStatus() const
+{
+    std::vector<PeerStatus> status;
+    status.reserve(peers_.size());
+    for (const auto &peer : peers_)
+        status.push_back({peer.first, peer.second.state, peer.second.warm_up_ms});
+    return status;
+}
+
+void SessionPool::SendKeepalive(uint64 peer, PeerState *state, SteamNetworkingMicroseconds now)
+{
+    SteamNetworkingIdentity identity;
+    identity.SetSteamID64(peer);
+    GetNetworkingTransport()->SendMessageToUser(identity, &kKeepalive, sizeof(kKeepalive),
+                                                k_nSteamNetworkingSend_Reliable |
+                                                    k_nSteamNetworkingSend_AutoRestartBrokenSession,
+                                                channel_);
+    state->last_send = now;
+}
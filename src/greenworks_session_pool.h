@@ -0,0 +1,77 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SRC_GREENWORKS_SESSION_POOL_H_
+#define SRC_GREENWORKS_SESSION_POOL_H_
+
+#include <map>
+#include <vector>
+
+#include "greenworks_networking_transport.h"
+
+// Opens ISteamNetworkingMessages sessions ahead of the first real message so relay route
+// discovery and session setup happen while a player is still joining. Warm sessions are kept
+// alive with small messages on a reserved channel and closed once idle. Driven from RunCallbacks.
+class SessionPool
+{
+  public:
+    enum EventType
+    {
+        kSessionStateChanged = 0,
+        kSessionIdleClosed = 1,
+    };
+
+    struct Event
+    {
+        EventType type;
+        uint64 peer;
+        ESteamNetworkingConnectionState state;
+        // Time from Prewarm() to the session first reaching Connected, -1 until it has.
+        int64 warm_up_ms;
+    };
+
+    struct PeerStatus
+    {
+        uint64 peer;
+        ESteamNetworkingConnectionState state;
+        int64 warm_up_ms;
+    };
+
+    explicit SessionPool(int channel);
+
+    // 0 disables the keepalive or the idle timeout.
+    void SetTimeouts(int keepalive_ms, int idle_timeout_ms);
+
+    // Starts opening a session unless |peer| is already pooled.
+    void Prewarm(uint64 peer);
+    // Records traffic to or from |peer|; does nothing for peers that are not pooled. Fed by the
+    // networking activity observer so traffic on every channel counts.
+    void Touch(uint64 peer);
+    void Remove(uint64 peer);
+
+    // Polls session states, sends keepalives and closes idle sessions. State changes are appended
+    // to |events|.
+    void Tick(std::vector<Event> *events);
+
+    std::vector<PeerStatus> GetStatus() const;
+
+  private:
+    struct PeerState
+    {
+        ESteamNetworkingConnectionState state;
+        SteamNetworkingMicroseconds started;
+        SteamNetworkingMicroseconds last_activity;
+        SteamNetworkingMicroseconds last_send;
+        int64 warm_up_ms;
+    };
+
+    void SendKeepalive(uint64 peer, PeerState *state, SteamNetworkingMicroseconds now);
+
+    int channel_;
+    SteamNetworkingMicroseconds keepalive_us_;
+    SteamNetworkingMicroseconds idle_timeout_us_;
+    std::map<uint64, PeerState> peers_;
+};
+
+#endif // SRC_GREENWORKS_SESSION_POOL_H_
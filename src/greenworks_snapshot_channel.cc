@@ -0,0 +1,299 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "greenworks_snapshot_channel.h"
+
+#include <chrono>
+#include <cstring>
+
+#include "steam/steamnetworkingtypes.h"
+
+namespace
+{
+
+enum SnapshotPacketType
+{
+    kSnapshotKeyframe = 1,
+    kSnapshotDelta = 2,
+    kSnapshotAck = 3,
+};
+
+const uint32 kHeaderSize = 17;
+
+// Send a keyframe once the newest acknowledged snapshot is this many sequences behind.
+const uint32 kKeyframeAckWindow = 30;
+
+// How many snapshots each side keeps around to serve as a delta base.
+const size_t kSnapshotHistory = 32;
+
+bool IsNewer(uint32 sequence, uint32 than)
+{
+    return static_cast<int32>(sequence - than) > 0;
+}
+
+void WriteUint32(uint8 *out, uint32 value)
+{
+    out[0] = static_cast<uint8>(value);
+    out[1] = static_cast<uint8>(value >> 8);
+    out[2] = static_cast<uint8>(value >> 16);
+    out[3] = static_cast<uint8>(value >> 24);
+}
+
+uint32 ReadUint32(const uint8 *in)
+{
+    return static_cast<uint32>(in[0]) | (static_cast<uint32>(in[1]) << 8) | (static_cast<uint32>(in[2]) << 16) |
+           (static_cast<uint32>(in[3]) << 24);
+}
+
+void WriteHeader(std::vector<uint8> *packet, uint8 type, uint32 stream, uint32 sequence, uint32 base_sequence,
+                 uint32 size)
+{
+    packet->resize(kHeaderSize);
+    uint8 *out = packet->data();
+    out[0] = type;
+    WriteUint32(out + 1, stream);
+    WriteUint32(out + 5, sequence);
+    WriteUint32(out + 9, base_sequence);
+    WriteUint32(out + 13, size);
+}
+
+void WriteVarint(std::vector<uint8> *out, uint32 value)
+{
+    while (value >= 0x80)
+    {
+        out->push_back(static_cast<uint8>(value | 0x80));
+        value >>= 7;
+    }
+    out->push_back(static_cast<uint8>(value));
+}
+
+bool ReadVarint(const uint8 *&in, const uint8 *end, uint32 *value)
+{
+    uint32 result = 0;
+    for (int shift = 0; shift < 35 && in < end; shift += 7)
+    {
+        uint8 byte = *in++;
+        result |= static_cast<uint32>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint8 XorAt(const uint8 *data, const std::vector<uint8> &base, uint32 i)
+{
+    return i < base.size() ? data[i] ^ base[i] : data[i];
+}
+
+// Appends the RLE encoded XOR of |data| against |base| to |out|.
+void EncodeDelta(const uint8 *data, uint32 size, const std::vector<uint8> &base, std::vector<uint8> *out)
+{
+    uint32 i = 0;
+    while (i < size)
+    {
+        uint32 zero_start = i;
+        while (i < size && XorAt(data, base, i) == 0)
+            ++i;
+        uint32 literal_start = i;
+        // A literal run ends at the first pair of zero bytes; single zeros are cheaper kept inline.
+        while (i < size && (XorAt(data, base, i) != 0 || (i + 1 < size && XorAt(data, base, i + 1) != 0)))
+            ++i;
+
+        WriteVarint(out, literal_start - zero_start);
+        WriteVarint(out, i - literal_start);
+        for (uint32 j = literal_start; j < i; ++j)
+            out->push_back(XorAt(data, base, j));
+    }
+}
+
+bool DecodeDelta(const uint8 *in, const uint8 *end, const std::vector<uint8> &base, uint32 size,
+                 std::vector<uint8> *out)
+{
+    out->assign(size, 0);
+    memcpy(out->data(), base.data(), base.size() < size ? base.size() : size);
+
+    uint32 pos = 0;
+    while (in < end)
+    {
+        uint32 zero_run, literal_length;
+        if (!ReadVarint(in, end, &zero_run) || !ReadVarint(in, end, &literal_length))
+            return false;
+        if (zero_run > size - pos || literal_length > size - pos - zero_run ||
+            literal_length > static_cast<uint32>(end - in))
+            return false;
+
+        pos += zero_run;
+        for (uint32 j = 0; j < literal_length; ++j)
+            (*out)[pos + j] ^= in[j];
+        pos += literal_length;
+        in += literal_length;
+    }
+    return true;
+}
+
+} // namespace
+
+const uint32 SnapshotChannel::kMaxSnapshotSize = k_cbMaxSteamNetworkingSocketsMessageSizeSend - kHeaderSize;
+
+SnapshotChannel::SnapshotChannel()
+{
+    memset(&stats_, 0, sizeof(stats_));
+    // Differs between runs so a restarted process never continues a stream the peer still remembers.
+    next_stream_ = static_cast<uint32>(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+void SnapshotChannel::Encode(uint64 peer, const uint8 *data, uint32 size, std::vector<uint8> *packet,
+                             uint32 *sequence)
+{
+    auto sender = senders_.find(peer);
+    if (sender == senders_.end())
+    {
+        sender = senders_.insert(std::make_pair(peer, SenderState())).first;
+        sender->second.stream = next_stream_++;
+    }
+
+    SenderState &state = sender->second;
+    uint32 current = state.next_sequence++;
+
+    bool use_delta = state.has_acked && !IsNewer(current, state.acked_sequence + kKeyframeAckWindow);
+    if (use_delta)
+    {
+        WriteHeader(packet, kSnapshotDelta, state.stream, current, state.acked_sequence, size);
+        EncodeDelta(data, size, state.acked_snapshot, packet);
+        // Nothing in common with the base; a keyframe is smaller.
+        if (packet->size() >= kHeaderSize + size)
+            use_delta = false;
+    }
+
+    if (!use_delta)
+    {
+        WriteHeader(packet, kSnapshotKeyframe, state.stream, current, current, size);
+        packet->insert(packet->end(), data, data + size);
+        ++stats_.keyframes_sent;
+    }
+    else
+    {
+        ++stats_.deltas_sent;
+    }
+
+    stats_.snapshot_bytes += size;
+    stats_.encoded_bytes += packet->size();
+
+    state.unacked_snapshots[current].assign(data, data + size);
+    while (state.unacked_snapshots.size() > kSnapshotHistory)
+        state.unacked_snapshots.erase(state.unacked_snapshots.begin());
+
+    *sequence = current;
+}
+
+bool SnapshotChannel::Decode(uint64 peer, const uint8 *data, uint32 size, std::vector<uint8> *snapshot,
+                             uint32 *sequence, std::vector<uint8> *ack)
+{
+    if (size < kHeaderSize)
+    {
+        ++stats_.snapshots_dropped;
+        return false;
+    }
+
+    uint8 type = data[0];
+    uint32 stream = ReadUint32(data + 1);
+    uint32 current = ReadUint32(data + 5);
+    uint32 base_sequence = ReadUint32(data + 9);
+    uint32 snapshot_size = ReadUint32(data + 13);
+    const uint8 *payload = data + kHeaderSize;
+    const uint8 *end = data + size;
+
+    if (type == kSnapshotAck)
+    {
+        HandleAck(peer, stream, current);
+        return false;
+    }
+
+    // The size comes from the peer; never let it pick the allocation.
+    if (snapshot_size > kMaxSnapshotSize)
+    {
+        ++stats_.snapshots_dropped;
+        return false;
+    }
+
+    ReceiverState &state = receivers_[peer];
+    if (state.stream != stream)
+    {
+        // The peer restarted its sender; nothing we hold is a valid base any more.
+        state = ReceiverState();
+        state.stream = stream;
+    }
+
+    // Unreliable delivery: anything not newer than what JS already has is stale.
+    if (state.has_latest && !IsNewer(current, state.latest_sequence))
+    {
+        ++stats_.snapshots_dropped;
+        return false;
+    }
+
+    if (type == kSnapshotKeyframe)
+    {
+        if (static_cast<uint32>(end - payload) != snapshot_size)
+        {
+            ++stats_.snapshots_dropped;
+            return false;
+        }
+        snapshot->assign(payload, end);
+    }
+    else if (type == kSnapshotDelta)
+    {
+        auto base = state.snapshots.find(base_sequence);
+        if (base == state.snapshots.end() || !DecodeDelta(payload, end, base->second, snapshot_size, snapshot))
+        {
+            // The sender falls back to a keyframe once our acks stop arriving.
+            ++stats_.snapshots_dropped;
+            return false;
+        }
+    }
+    else
+    {
+        ++stats_.snapshots_dropped;
+        return false;
+    }
+
+    state.has_latest = true;
+    state.latest_sequence = current;
+    state.snapshots[current] = *snapshot;
+    while (state.snapshots.size() > kSnapshotHistory)
+        state.snapshots.erase(state.snapshots.begin());
+
+    ++stats_.snapshots_received;
+    *sequence = current;
+    WriteHeader(ack, kSnapshotAck, stream, current, 0, 0);
+    return true;
+}
+
+void SnapshotChannel::HandleAck(uint64 peer, uint32 stream, uint32 sequence)
+{
+    auto sender = senders_.find(peer);
+    if (sender == senders_.end() || sender->second.stream != stream)
+        return;
+
+    SenderState &state = sender->second;
+    if (state.has_acked && !IsNewer(sequence, state.acked_sequence))
+        return;
+
+    auto acked = state.unacked_snapshots.find(sequence);
+    if (acked == state.unacked_snapshots.end())
+        return;
+
+    state.has_acked = true;
+    state.acked_sequence = sequence;
+    state.acked_snapshot.swap(acked->second);
+    state.unacked_snapshots.erase(state.unacked_snapshots.begin(), ++acked);
+}
+
+void SnapshotChannel::ResetPeer(uint64 peer)
+{
+    senders_.erase(peer);
+    receivers_.erase(peer);
+}
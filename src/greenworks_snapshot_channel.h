@@ -0,0 +1,86 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SRC_GREENWORKS_SNAPSHOT_CHANNEL_H_
+#define SRC_GREENWORKS_SNAPSHOT_CHANNEL_H_
+
+#include <map>
+#include <vector>
+
+#include "steam/steamtypes.h"
+
+// Delta-compresses world snapshots per peer.
+//
+// Every packet starts with a 17 byte header:
+//   uint8  type            keyframe, delta or ack
+//   uint32 stream          id that changes whenever the sender (re)starts for a peer
+//   uint32 sequence        snapshot sequence (the acknowledged sequence for acks)
+//   uint32 base_sequence   snapshot the delta was encoded against
+//   uint32 size            size of the reconstructed snapshot
+//
+// Deltas are the XOR of the snapshot against the last snapshot the peer acknowledged, run-length
+// encoded as (zero run, literal length, literal bytes) varint triples. When acks stop arriving the
+// sender falls back to keyframes, so a lost packet never stalls the channel.
+class SnapshotChannel
+{
+  public:
+    struct Stats
+    {
+        uint64 keyframes_sent;
+        uint64 deltas_sent;
+        uint64 snapshot_bytes;
+        uint64 encoded_bytes;
+        uint64 snapshots_received;
+        uint64 snapshots_dropped;
+    };
+
+    // Largest snapshot a keyframe can carry in one message. Packets claiming more are dropped.
+    static const uint32 kMaxSnapshotSize;
+
+    SnapshotChannel();
+
+    // Encodes |data| as the next snapshot for |peer| into |packet|.
+    void Encode(uint64 peer, const uint8 *data, uint32 size, std::vector<uint8> *packet, uint32 *sequence);
+
+    // Handles a packet received from |peer|. Returns true and fills |snapshot| when a full snapshot was
+    // reconstructed; |ack| is then set to the packet that should be sent back to the peer.
+    bool Decode(uint64 peer, const uint8 *data, uint32 size, std::vector<uint8> *snapshot, uint32 *sequence,
+                std::vector<uint8> *ack);
+
+    // Forgets everything about |peer|, e.g. when the session is closed.
+    void ResetPeer(uint64 peer);
+
+    const Stats &GetStats() const
+    {
+        return stats_;
+    }
+
+  private:
+    struct SenderState
+    {
+        uint32 stream;
+        uint32 next_sequence;
+        bool has_acked;
+        uint32 acked_sequence;
+        std::vector<uint8> acked_snapshot;
+        std::map<uint32, std::vector<uint8>> unacked_snapshots;
+    };
+
+    struct ReceiverState
+    {
+        uint32 stream;
+        bool has_latest;
+        uint32 latest_sequence;
+        std::map<uint32, std::vector<uint8>> snapshots;
+    };
+
+    void HandleAck(uint64 peer, uint32 stream, uint32 sequence);
+
+    std::map<uint64, SenderState> senders_;
+    std::map<uint64, ReceiverState> receivers_;
+    Stats stats_;
+    uint32 next_stream_;
+};
+
+#endif // SRC_GREENWORKS_SNAPSHOT_CHANNEL_H_
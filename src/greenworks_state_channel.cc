@@ -0,0 +1,196 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "greenworks_state_channel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+
+namespace
+{
+
+const uint32 kPacketHeaderSize = 4;
+const uint32 kUpdateHeaderSize = 10;
+
+// Updates are batched up to about one MTU so a packet is rarely fragmented.
+const uint32 kTargetPacketSize = 1200;
+
+bool IsNewer(uint32 sequence, uint32 than)
+{
+    return static_cast<int32>(sequence - than) > 0;
+}
+
+void WriteUint16(uint8 *out, uint32 value)
+{
+    out[0] = static_cast<uint8>(value);
+    out[1] = static_cast<uint8>(value >> 8);
+}
+
+void WriteUint32(uint8 *out, uint32 value)
+{
+    out[0] = static_cast<uint8>(value);
+    out[1] = static_cast<uint8>(value >> 8);
+    out[2] = static_cast<uint8>(value >> 16);
+    out[3] = static_cast<uint8>(value >> 24);
+}
+
+uint32 ReadUint16(const uint8 *in)
+{
+    return static_cast<uint32>(in[0]) | (static_cast<uint32>(in[1]) << 8);
+}
+
+uint32 ReadUint32(const uint8 *in)
+{
+    return static_cast<uint32>(in[0]) | (static_cast<uint32>(in[1]) << 8) | (static_cast<uint32>(in[2]) << 16) |
+           (static_cast<uint32>(in[3]) << 24);
+}
+
+} // namespace
+
+StateChannel::StateChannel() : next_order_(0)
+{
+    memset(&stats_, 0, sizeof(stats_));
+    // Differs between runs so a restarted process never continues a stream the peer still remembers.
+    next_stream_ = static_cast<uint32>(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+void StateChannel::Queue(uint64 peer, uint32 key, const uint8 *data, uint32 size)
+{
+    auto sender = senders_.find(peer);
+    if (sender == senders_.end())
+    {
+        sender = senders_.insert(std::make_pair(peer, SenderState())).first;
+        sender->second.stream = next_stream_++;
+    }
+
+    SenderState &state = sender->second;
+    uint32 sequence = ++state.next_sequence[key];
+
+    auto pending = state.pending.find(key);
+    if (pending == state.pending.end())
+    {
+        pending = state.pending.insert(std::make_pair(key, PendingUpdate())).first;
+        pending->second.order = next_order_++;
+    }
+    else
+    {
+        ++stats_.updates_replaced;
+    }
+
+    pending->second.sequence = sequence;
+    pending->second.data.assign(data, data + size);
+    ++stats_.updates_queued;
+}
+
+void StateChannel::Flush(uint32 max_bytes_per_peer, std::vector<std::pair<uint64, std::vector<uint8>>> *packets)
+{
+    for (auto &sender : senders_)
+    {
+        SenderState &state = sender.second;
+        if (state.pending.empty())
+            continue;
+
+        std::vector<std::pair<uint64, uint32>> order;
+        order.reserve(state.pending.size());
+        for (const auto &pending : state.pending)
+            order.push_back(std::make_pair(pending.second.order, pending.first));
+        std::sort(order.begin(), order.end());
+
+        uint32 budget_used = 0;
+        std::vector<uint8> packet;
+        for (const auto &entry : order)
+        {
+            auto pending = state.pending.find(entry.second);
+            uint32 size = static_cast<uint32>(pending->second.data.size());
+            uint32 update_size = kUpdateHeaderSize + size;
+
+            if (!packet.empty() && packet.size() + update_size > kTargetPacketSize)
+            {
+                stats_.bytes_sent += packet.size();
+                ++stats_.packets_sent;
+                packets->push_back(std::make_pair(sender.first, std::vector<uint8>()));
+                packets->back().second.swap(packet);
+            }
+
+            uint32 added = update_size + (packet.empty() ? kPacketHeaderSize : 0);
+            if (max_bytes_per_peer > 0 && budget_used + added > max_bytes_per_peer)
+                break;
+            budget_used += added;
+
+            if (packet.empty())
+            {
+                packet.resize(kPacketHeaderSize);
+                WriteUint32(packet.data(), state.stream);
+            }
+
+            size_t offset = packet.size();
+            packet.resize(offset + update_size);
+            WriteUint32(&packet[offset], entry.second);
+            WriteUint32(&packet[offset + 4], pending->second.sequence);
+            WriteUint16(&packet[offset + 8], size);
+            if (size > 0)
+                memcpy(&packet[offset + kUpdateHeaderSize], pending->second.data.data(), size);
+
+            state.pending.erase(pending);
+            ++stats_.updates_sent;
+        }
+
+        if (!packet.empty())
+        {
+            stats_.bytes_sent += packet.size();
+            ++stats_.packets_sent;
+            packets->push_back(std::make_pair(sender.first, std::vector<uint8>()));
+            packets->back().second.swap(packet);
+        }
+    }
+}
+
+void StateChannel::Decode(uint64 peer, const uint8 *data, uint32 size, std::vector<Update> *updates)
+{
+    if (size < kPacketHeaderSize)
+        return;
+
+    uint32 stream = ReadUint32(data);
+
+    ReceiverState &state = receivers_[peer];
+    if (state.stream != stream)
+    {
+        // The peer restarted its sender; its sequences start over.
+        state.latest_sequence.clear();
+        state.stream = stream;
+    }
+
+    const uint8 *in = data + kPacketHeaderSize;
+    const uint8 *end = data + size;
+    while (end - in >= static_cast<ptrdiff_t>(kUpdateHeaderSize))
+    {
+        Update update;
+        update.key = ReadUint32(in);
+        update.sequence = ReadUint32(in + 4);
+        update.size = ReadUint16(in + 8);
+        update.data = in + kUpdateHeaderSize;
+        if (static_cast<uint32>(end - update.data) < update.size)
+            break;
+        in = update.data + update.size;
+
+        auto latest = state.latest_sequence.find(update.key);
+        if (latest != state.latest_sequence.end() && !IsNewer(update.sequence, latest->second))
+        {
+            ++stats_.updates_dropped;
+            continue;
+        }
+
+        state.latest_sequence[update.key] = update.sequence;
+        updates->push_back(update);
+        ++stats_.updates_received;
+    }
+}
+
+void StateChannel::ResetPeer(uint64 peer)
+{
+    senders_.erase(peer);
+    receivers_.erase(peer);
+}
@@ -0,0 +1,101 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SRC_GREENWORKS_STATE_CHANNEL_H_
+#define SRC_GREENWORKS_STATE_CHANNEL_H_
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "steam/steamtypes.h"
+
+// Latest-value-wins updates keyed by (peer, key), e.g. entity transforms.
+//
+// Queuing an update replaces any unsent update for the same key, so only the newest value is ever
+// sent. Updates for one peer are batched into packets of:
+//   uint32 stream          id that changes whenever the sender (re)starts for a peer
+// followed by any number of
+//   uint32 key
+//   uint32 sequence        per key, incremented on every queued update
+//   uint16 size
+//   uint8  data[size]
+// The receiver drops any update whose sequence is not newer than the last one it delivered for
+// that key, so reordered unreliable packets never move state backwards.
+class StateChannel
+{
+  public:
+    struct Stats
+    {
+        uint64 updates_queued;
+        uint64 updates_replaced;
+        uint64 updates_sent;
+        uint64 packets_sent;
+        uint64 bytes_sent;
+        uint64 updates_received;
+        uint64 updates_dropped;
+    };
+
+    struct Update
+    {
+        uint32 key;
+        uint32 sequence;
+        // Points into the packet passed to Decode().
+        const uint8 *data;
+        uint32 size;
+    };
+
+    // Largest payload of a single update.
+    static const uint32 kMaxUpdateSize = 0xffff;
+
+    StateChannel();
+
+    void Queue(uint64 peer, uint32 key, const uint8 *data, uint32 size);
+
+    // Moves queued updates into packets, longest waiting key first. At most |max_bytes_per_peer|
+    // bytes of packets are built per peer (0 for no limit); whatever does not fit stays queued and
+    // can still be replaced.
+    void Flush(uint32 max_bytes_per_peer, std::vector<std::pair<uint64, std::vector<uint8>>> *packets);
+
+    // Appends the updates in |data| that are newer than anything delivered before to |updates|.
+    void Decode(uint64 peer, const uint8 *data, uint32 size, std::vector<Update> *updates);
+
+    // Forgets everything about |peer|, e.g. when the session is closed.
+    void ResetPeer(uint64 peer);
+
+    const Stats &GetStats() const
+    {
+        return stats_;
+    }
+
+  private:
+    struct PendingUpdate
+    {
+        uint32 sequence;
+        // When the key was first queued since its last send; replacing keeps its place in line.
+        uint64 order;
+        std::vector<uint8> data;
+    };
+
+    struct SenderState
+    {
+        uint32 stream;
+        std::map<uint32, uint32> next_sequence;
+        std::map<uint32, PendingUpdate> pending;
+    };
+
+    struct ReceiverState
+    {
+        uint32 stream;
+        std::map<uint32, uint32> latest_sequence;
+    };
+
+    std::map<uint64, SenderState> senders_;
+    std::map<uint64, ReceiverState> receivers_;
+    Stats stats_;
+    uint32 next_stream_;
+    uint64 next_order_;
+};
+
+#endif // SRC_GREENWORKS_STATE_CHANNEL_H_
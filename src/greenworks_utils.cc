@@ -103,6 +103,61 @@ void InitUserUgcListSortOrder(Napi::Env env, Napi::Object exports)
     (exports).Set("UserUGCListSortOrder", ugc_list_sort_order);
 }
 
+Napi::Object GetRelayNetworkStatusObject(Napi::Env env, const SteamRelayNetworkStatus_t &status)
+{
+    Napi::Object result = Napi::Object::New(env);
+
+    result.Set("availabilitySummary", Napi::Number::New(env, status.m_eAvail));
+    result.Set("availabilityNetworkConfig", Napi::Number::New(env, status.m_eAvailNetworkConfig));
+    result.Set("availabilityAnyRelay", Napi::Number::New(env, status.m_eAvailAnyRelay));
+    result.Set("debugMessage", Napi::String::New(env, status.m_debugMsg));
+
+    return result;
+}
+
+bool GetNetworkingConfigValue(const std::string &name, ESteamNetworkingConfigValue *value,
+                              ESteamNetworkingConfigDataType *type)
+{
+    static const struct
+    {
+        const char *name;
+        ESteamNetworkingConfigValue value;
+        ESteamNetworkingConfigDataType type;
+    } kConfigValues[] = {
+        {"FakePacketLag_Send", k_ESteamNetworkingConfig_FakePacketLag_Send, k_ESteamNetworkingConfig_Int32},
+        {"FakePacketLag_Recv", k_ESteamNetworkingConfig_FakePacketLag_Recv, k_ESteamNetworkingConfig_Int32},
+        {"FakePacketLoss_Send", k_ESteamNetworkingConfig_FakePacketLoss_Send, k_ESteamNetworkingConfig_Float},
+        {"FakePacketLoss_Recv", k_ESteamNetworkingConfig_FakePacketLoss_Recv, k_ESteamNetworkingConfig_Float},
+        {"FakePacketReorder_Send", k_ESteamNetworkingConfig_FakePacketReorder_Send, k_ESteamNetworkingConfig_Float},
+        {"FakePacketReorder_Recv", k_ESteamNetworkingConfig_FakePacketReorder_Recv, k_ESteamNetworkingConfig_Float},
+        {"FakePacketReorder_Time", k_ESteamNetworkingConfig_FakePacketReorder_Time, k_ESteamNetworkingConfig_Int32},
+        {"FakePacketDup_Send", k_ESteamNetworkingConfig_FakePacketDup_Send, k_ESteamNetworkingConfig_Float},
+        {"FakePacketDup_Recv", k_ESteamNetworkingConfig_FakePacketDup_Recv, k_ESteamNetworkingConfig_Float},
+        {"FakePacketDup_TimeMax", k_ESteamNetworkingConfig_FakePacketDup_TimeMax, k_ESteamNetworkingConfig_Int32},
+        {"FakeRateLimit_Send_Rate", k_ESteamNetworkingConfig_FakeRateLimit_Send_Rate, k_ESteamNetworkingConfig_Int32},
+        {"FakeRateLimit_Send_Burst", k_ESteamNetworkingConfig_FakeRateLimit_Send_Burst,
+         k_ESteamNetworkingConfig_Int32},
+        {"FakeRateLimit_Recv_Rate", k_ESteamNetworkingConfig_FakeRateLimit_Recv_Rate, k_ESteamNetworkingConfig_Int32},
+        {"FakeRateLimit_Recv_Burst", k_ESteamNetworkingConfig_FakeRateLimit_Recv_Burst,
+         k_ESteamNetworkingConfig_Int32},
+        {"NagleTime", k_ESteamNetworkingConfig_NagleTime, k_ESteamNetworkingConfig_Int32},
+        {"SendBufferSize", k_ESteamNetworkingConfig_SendBufferSize, k_ESteamNetworkingConfig_Int32},
+        {"SendRateMin", k_ESteamNetworkingConfig_SendRateMin, k_ESteamNetworkingConfig_Int32},
+        {"SendRateMax", k_ESteamNetworkingConfig_SendRateMax, k_ESteamNetworkingConfig_Int32},
+    };
+
+    for (const auto &config : kConfigValues)
+    {
+        if (name == config.name)
+        {
+            *value = config.value;
+            *type = config.type;
+            return true;
+        }
+    }
+    return false;
+}
+
 void sleep(int milliseconds)
 {
     std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
@@ -9,6 +9,7 @@
 
 // ReSharper disable once CppUnusedIncludeDirective
 #include "napi.h"
+#include "steam/steamnetworkingtypes.h"
 #include "steam/steamtypes.h"
 #include "uv.h"
 #include "v8.h"
@@ -26,6 +27,13 @@ void InitUserUgcListSortOrder(Napi::Env env, Napi::Object exports);
 
 void InitUserUgcList(Napi::Env env, Napi::Object exports);
 
+Napi::Object GetRelayNetworkStatusObject(Napi::Env env, const SteamRelayNetworkStatus_t &status);
+
+// Looks up the networking config value accepted by networking.setConfigValue under |name|, e.g.
+// "FakePacketLag_Send". Returns false for names that are not exposed.
+bool GetNetworkingConfigValue(const std::string &name, ESteamNetworkingConfigValue *value,
+                              ESteamNetworkingConfigDataType *type);
+
 void sleep(int milliseconds);
 
 bool WriteFile(const std::string &target_path, char *content, int length);
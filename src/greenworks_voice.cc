@@ -0,0 +1,212 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "greenworks_voice.h"
+
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+
+// Steam buffers about a second of voice; polling well inside a 20ms frame keeps capture latency low.
+const std::chrono::milliseconds kPollInterval(10);
+
+const size_t kCompressedBufferSize = 8 * 1024;
+// Valve's recommendation for DecompressVoice; grown if a frame ever needs more.
+const size_t kPcmBufferSize = 22 * 1024;
+
+// Decoded audio kept per peer while it has not been collected.
+const uint32 kMaxBufferedSeconds = 1;
+
+} // namespace
+
+VoiceChat::VoiceChat()
+    : wake_pending_(false), recording_(false), sample_rate_(0), running_(false),
+      compressed_buffer_(kCompressedBufferSize), pcm_buffer_(kPcmBufferSize / sizeof(int16))
+{
+    memset(&stats_, 0, sizeof(stats_));
+}
+
+VoiceChat::~VoiceChat()
+{
+    Stop();
+}
+
+void VoiceChat::Start(std::function<void()> wake)
+{
+    Stop();
+
+    sample_rate_ = SteamUser()->GetVoiceOptimalSampleRate();
+    wake_ = wake;
+    wake_pending_ = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = true;
+    }
+    thread_ = std::thread(&VoiceChat::Run, this);
+}
+
+void VoiceChat::Stop()
+{
+    if (!thread_.joinable())
+        return;
+
+    SetRecording(false);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    wake_thread_.notify_one();
+    thread_.join();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    inbound_.clear();
+    captured_.clear();
+    decoded_.clear();
+}
+
+bool VoiceChat::IsRunning() const
+{
+    return thread_.joinable();
+}
+
+void VoiceChat::SetRecording(bool recording)
+{
+    if (recording_.exchange(recording) == recording)
+        return;
+
+    if (recording)
+        SteamUser()->StartVoiceRecording();
+    else
+        SteamUser()->StopVoiceRecording();
+}
+
+uint32 VoiceChat::GetSampleRate() const
+{
+    return sample_rate_;
+}
+
+void VoiceChat::PushInbound(uint64 peer, const void *data, uint32 size)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_)
+            return;
+
+        InboundFrame frame;
+        frame.peer = peer;
+        frame.data.assign(static_cast<const uint8 *>(data), static_cast<const uint8 *>(data) + size);
+        inbound_.push_back(std::move(frame));
+        ++stats_.frames_received;
+    }
+    wake_thread_.notify_one();
+}
+
+void VoiceChat::Take(std::vector<std::vector<uint8>> *captured, std::map<uint64, std::vector<float>> *decoded)
+{
+    wake_pending_ = false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    captured->swap(captured_);
+    decoded->swap(decoded_);
+    captured_.clear();
+    decoded_.clear();
+}
+
+VoiceChat::Stats VoiceChat::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void VoiceChat::Run()
+{
+    std::vector<InboundFrame> inbound;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_thread_.wait_for(lock, kPollInterval, [this] { return !running_ || !inbound_.empty(); });
+            if (!running_)
+                return;
+            inbound.swap(inbound_);
+        }
+
+        // Steam keeps handing out the tail of the recording for a moment after it is stopped.
+        bool produced = Capture();
+        for (const InboundFrame &frame : inbound)
+            produced = Decode(frame) || produced;
+        inbound.clear();
+
+        if (produced && !wake_pending_.exchange(true))
+            wake_();
+    }
+}
+
+bool VoiceChat::Capture()
+{
+    uint32 available = 0;
+    if (SteamUser()->GetAvailableVoice(&available) != k_EVoiceResultOK || available == 0)
+        return false;
+
+    if (available > compressed_buffer_.size())
+        compressed_buffer_.resize(available);
+
+    uint32 written = 0;
+    if (SteamUser()->GetVoice(true, compressed_buffer_.data(), static_cast<uint32>(compressed_buffer_.size()),
+                              &written) != k_EVoiceResultOK ||
+        written == 0)
+        return false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    captured_.push_back(std::vector<uint8>(compressed_buffer_.begin(), compressed_buffer_.begin() + written));
+    ++stats_.frames_captured;
+    stats_.bytes_captured += written;
+    return true;
+}
+
+bool VoiceChat::Decode(const InboundFrame &frame)
+{
+    uint32 written = 0;
+    EVoiceResult result;
+    for (;;)
+    {
+        result = SteamUser()->DecompressVoice(frame.data.data(), static_cast<uint32>(frame.data.size()),
+                                              pcm_buffer_.data(),
+                                              static_cast<uint32>(pcm_buffer_.size() * sizeof(int16)), &written,
+                                              sample_rate_);
+        if (result != k_EVoiceResultBufferTooSmall || written <= pcm_buffer_.size() * sizeof(int16))
+            break;
+        // |written| holds the size that is needed.
+        pcm_buffer_.resize(written / sizeof(int16) + 1);
+    }
+
+    if (result != k_EVoiceResultOK)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.decode_errors;
+        return false;
+    }
+
+    uint32 samples = written / sizeof(int16);
+    if (samples == 0)
+        return false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<float> &pcm = decoded_[frame.peer];
+    size_t offset = pcm.size();
+    pcm.resize(offset + samples);
+    for (uint32 i = 0; i < samples; i++)
+        pcm[offset + i] = pcm_buffer_[i] / 32768.0f;
+
+    size_t maxSamples = static_cast<size_t>(sample_rate_) * kMaxBufferedSeconds;
+    if (pcm.size() > maxSamples)
+    {
+        stats_.samples_dropped += pcm.size() - maxSamples;
+        pcm.erase(pcm.begin(), pcm.end() - maxSamples);
+    }
+    stats_.samples_decoded += samples;
+    return true;
+}
@@ -0,0 +1,88 @@
+// Copyright (c) 2014 Greenheart Games Pty. Ltd. All rights reserved.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef SRC_GREENWORKS_VOICE_H_
+#define SRC_GREENWORKS_VOICE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "steam/steam_api.h"
+
+// Steam voice capture and decode on a background thread.
+//
+// The thread polls ISteamUser::GetVoice every few milliseconds while recording, and decompresses
+// frames handed in with PushInbound() to float PCM at the optimal sample rate. Whenever it has
+// produced something it calls the wake function once; the owner then collects the compressed frames
+// to send and the decoded audio with Take() on its own thread. Networking stays on that thread.
+class VoiceChat
+{
+  public:
+    struct Stats
+    {
+        uint64 frames_captured;
+        uint64 bytes_captured;
+        uint64 frames_received;
+        uint64 samples_decoded;
+        // Decoded audio thrown away because it was not collected in time.
+        uint64 samples_dropped;
+        uint64 decode_errors;
+    };
+
+    VoiceChat();
+    ~VoiceChat();
+
+    VoiceChat(const VoiceChat &) = delete;
+    VoiceChat &operator=(const VoiceChat &) = delete;
+
+    // |wake| is called on the voice thread, at most once per Take().
+    void Start(std::function<void()> wake);
+    void Stop();
+    bool IsRunning() const;
+
+    void SetRecording(bool recording);
+    uint32 GetSampleRate() const;
+
+    void PushInbound(uint64 peer, const void *data, uint32 size);
+
+    void Take(std::vector<std::vector<uint8>> *captured, std::map<uint64, std::vector<float>> *decoded);
+
+    Stats GetStats() const;
+
+  private:
+    struct InboundFrame
+    {
+        uint64 peer;
+        std::vector<uint8> data;
+    };
+
+    void Run();
+    bool Capture();
+    bool Decode(const InboundFrame &frame);
+
+    std::thread thread_;
+    std::function<void()> wake_;
+    std::atomic<bool> wake_pending_;
+    std::atomic<bool> recording_;
+    uint32 sample_rate_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_thread_;
+    bool running_;
+    std::vector<InboundFrame> inbound_;
+    std::vector<std::vector<uint8>> captured_;
+    std::map<uint64, std::vector<float>> decoded_;
+    Stats stats_;
+
+    // Only touched by the voice thread.
+    std::vector<uint8> compressed_buffer_;
+    std::vector<int16> pcm_buffer_;
+};
+
+#endif // SRC_GREENWORKS_VOICE_H_
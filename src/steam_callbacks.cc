@@ -4,6 +4,9 @@
 
 #include "steam_callbacks.h"
 
+#include <cstring>
+#include <string>
+
 #include "napi.h"
 #include "uv.h"
 #include "v8.h"
@@ -16,9 +19,11 @@ SteamCallbacks::SteamCallbacks()
       SETUP_STEAM_CALLBACK_MEMBER(OnLobbyChatUpdate), SETUP_STEAM_CALLBACK_MEMBER(OnLobbyJoinRequested),
       SETUP_STEAM_CALLBACK_MEMBER(OnP2PSessionRequest), SETUP_STEAM_CALLBACK_MEMBER(OnP2PSessionConnectFail),
       SETUP_STEAM_CALLBACK_MEMBER(OnSteamNetworkingMessagesSessionRequest),
-      SETUP_STEAM_CALLBACK_MEMBER(OnSteamNetworkingMessagesSessionFailed)
+      SETUP_STEAM_CALLBACK_MEMBER(OnSteamNetworkingMessagesSessionFailed),
+      SETUP_STEAM_CALLBACK_MEMBER(OnRelayNetworkStatus), hasRelayNetworkStatus(false)
     //   SETUP_STEAM_CALLBACK_MEMBER(OnSteamNetworkingConnectionStatus)
 {
+    memset(&relayNetworkStatus, 0, sizeof(relayNetworkStatus));
 }
 
 void SteamCallbacks::OnGameOverlayActivated(GameOverlayActivated_t *pCallback)
@@ -146,6 +151,86 @@ void SteamCallbacks::OnSteamNetworkingMessagesSessionFailed(SteamNetworkingMessa
     }
 }
 
+void SteamCallbacks::OnRelayNetworkStatus(SteamRelayNetworkStatus_t *pCallback)
+{
+    UpdateRelayNetworkStatus(*pCallback);
+
+    if (!OnRelayNetworkStatusCallback.IsEmpty())
+    {
+        Napi::Env env = OnRelayNetworkStatusCallback.Env();
+
+        OnRelayNetworkStatusCallback.Call({utils::GetRelayNetworkStatusObject(env, relayNetworkStatus)});
+    }
+}
+
+void SteamCallbacks::UpdateRelayNetworkStatus(const SteamRelayNetworkStatus_t &status)
+{
+    relayNetworkStatus = status;
+    hasRelayNetworkStatus = true;
+
+    if (relayNetworkWaiters.empty())
+    {
+        return;
+    }
+
+    bool ready = status.m_eAvail == k_ESteamNetworkingAvailability_Current;
+    bool failed = status.m_eAvail == k_ESteamNetworkingAvailability_CannotTry ||
+                  status.m_eAvail == k_ESteamNetworkingAvailability_Failed;
+    if (!ready && !failed)
+    {
+        return;
+    }
+
+    // Settling a promise can run JS that queues another waiter, so swap the list out first.
+    std::vector<RelayNetworkWaiter> waiters;
+    waiters.swap(relayNetworkWaiters);
+
+    for (auto &waiter : waiters)
+    {
+        Napi::Env env = waiter.deferred.Env();
+        if (ready)
+        {
+            waiter.deferred.Resolve(utils::GetRelayNetworkStatusObject(env, relayNetworkStatus));
+        }
+        else
+        {
+            waiter.deferred.Reject(
+                Napi::Error::New(env, std::string("Relay network unavailable: ") + relayNetworkStatus.m_debugMsg)
+                    .Value());
+        }
+    }
+}
+
+void SteamCallbacks::ExpireRelayNetworkWaiters()
+{
+    if (relayNetworkWaiters.empty())
+    {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+
+    std::vector<RelayNetworkWaiter> expired;
+    for (auto it = relayNetworkWaiters.begin(); it != relayNetworkWaiters.end();)
+    {
+        if (it->hasDeadline && it->deadline <= now)
+        {
+            expired.push_back(*it);
+            it = relayNetworkWaiters.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    for (auto &waiter : expired)
+    {
+        Napi::Env env = waiter.deferred.Env();
+        waiter.deferred.Reject(Napi::Error::New(env, "Timed out waiting for relay network").Value());
+    }
+}
+
 // void SteamCallbacks::OnSteamNetworkingConnectionStatus(SteamNetConnectionStatusChangedCallback_t *pCallback)
 // {
 //     if (!OnSteamNetworkingConnectionStatusCallback.IsEmpty())
@@ -5,6 +5,9 @@
 #ifndef SRC_STEAM_CALLBACKS_H_
 #define SRC_STEAM_CALLBACKS_H_
 
+#include <chrono>
+#include <vector>
+
 #include "napi.h"
 #include "steam/isteamnetworking.h"
 #include "steam/isteamnetworkingutils.h"
@@ -18,6 +21,14 @@
 
 #define SETUP_STEAM_CALLBACK_MEMBER(name) m_Callback##name(this, &SteamCallbacks::name)
 
+// A pending waitForRelayNetwork() promise.
+struct RelayNetworkWaiter
+{
+    Napi::Promise::Deferred deferred;
+    bool hasDeadline;
+    std::chrono::steady_clock::time_point deadline;
+};
+
 class SteamCallbacks
 {
   public:
@@ -33,6 +44,16 @@ class SteamCallbacks
     SETUP_STEAM_CALLBACK_DECLARATION(OnP2PSessionConnectFail, P2PSessionConnectFail_t);
     SETUP_STEAM_CALLBACK_DECLARATION(OnSteamNetworkingMessagesSessionRequest, SteamNetworkingMessagesSessionRequest_t);
     SETUP_STEAM_CALLBACK_DECLARATION(OnSteamNetworkingMessagesSessionFailed, SteamNetworkingMessagesSessionFailed_t);
+    SETUP_STEAM_CALLBACK_DECLARATION(OnRelayNetworkStatus, SteamRelayNetworkStatus_t);
+
+    // Last relay network status posted by Steam. Only valid once hasRelayNetworkStatus is set.
+    SteamRelayNetworkStatus_t relayNetworkStatus;
+    bool hasRelayNetworkStatus;
+    std::vector<RelayNetworkWaiter> relayNetworkWaiters;
+
+    void UpdateRelayNetworkStatus(const SteamRelayNetworkStatus_t &status);
+    // Rejects waiters whose timeout has elapsed. Called from RunCallbacks.
+    void ExpireRelayNetworkWaiters();
 
     // not called for SteamNetworkingMessages :(
     // SETUP_STEAM_CALLBACK_DECLARATION(OnSteamNetworkingConnectionStatus, SteamNetConnectionStatusChangedCallback_t);
@@ -0,0 +1,88 @@
+// Measures saveFilesToCloud throughput with and without a progress callback, and with cloud
+// compression on. Needs a built addon in lib/ and a running Steam client with steam_appid.txt
+// in the working directory.
+//
+// Usage: node tools/bench_save_files.js [fileCount] [fileSizeMB] [rounds]
+
+var fs = require("fs");
+var os = require("os");
+var path = require("path");
+var greenworks = require("../greenworks");
+
+var fileCount = parseInt(process.argv[2] || "4", 10);
+var fileSize = parseInt(process.argv[3] || "16", 10) * 1024 * 1024;
+var rounds = parseInt(process.argv[4] || "3", 10);
+
+if (!greenworks.initialize()) {
+    console.error("Steam API initialization failed");
+    process.exit(1);
+}
+
+var dir = fs.mkdtempSync(path.join(os.tmpdir(), "greenworks-bench-"));
+var files = [];
+for (var i = 0; i < fileCount; i++) {
+    var file = path.join(dir, "bench_" + i + ".bin");
+    // Half random, half zeroes, so compression has something to do without being trivial.
+    var data = Buffer.alloc(fileSize);
+    require("crypto").randomFillSync(data, 0, fileSize / 2);
+    fs.writeFileSync(file, data);
+    files.push(file);
+}
+
+var cases = [
+    { name: "plain", compression: false, progress: false },
+    { name: "plain + progress", compression: false, progress: true },
+    { name: "compressed", compression: true, progress: false },
+    { name: "compressed + progress", compression: true, progress: true },
+];
+
+function runCase(c, round, done) {
+    greenworks.setCloudCompression(c.compression);
+    var progressCalls = 0;
+    var completed = false;
+    var lateProgress = 0;
+    var start = process.hrtime();
+    var progress = c.progress ? function() {
+        progressCalls++;
+        if (completed)
+            lateProgress++;
+    } : undefined;
+    greenworks.saveFilesToCloud(files, function(err) {
+        completed = true;
+        var elapsed = process.hrtime(start);
+        var seconds = elapsed[0] + elapsed[1] / 1e9;
+        if (err) {
+            console.error(c.name + ": " + err);
+        } else {
+            var mb = fileCount * fileSize / (1024 * 1024);
+            console.log(c.name + " #" + round + ": " + (mb / seconds).toFixed(1) + " MB/s, " +
+                progressCalls + " progress calls");
+        }
+        // Let any stray progress calls land before checking the ordering.
+        setTimeout(function() {
+            if (lateProgress)
+                console.error(c.name + ": " + lateProgress + " progress calls after completion");
+            done();
+        }, 100);
+    }, progress);
+}
+
+var tasks = [];
+cases.forEach(function(c) {
+    for (var r = 1; r <= rounds; r++)
+        tasks.push({ c: c, round: r });
+});
+
+var pump = setInterval(function() { greenworks.runCallbacks(); }, 10);
+
+(function next() {
+    var task = tasks.shift();
+    if (!task) {
+        clearInterval(pump);
+        greenworks.setCloudCompression(false);
+        files.forEach(function(file) { fs.unlinkSync(file); });
+        fs.rmdirSync(dir);
+        return;
+    }
+    runCase(task.c, task.round, next);
+})();